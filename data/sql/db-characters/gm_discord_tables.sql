@@ -19,6 +19,7 @@ CREATE TABLE `gm_discord_inbox` (
   `id` INT UNSIGNED NOT NULL AUTO_INCREMENT,
   `discord_user_id` BIGINT UNSIGNED NOT NULL,
   `action` VARCHAR(16) NOT NULL,
+  `lane` TINYINT UNSIGNED NOT NULL DEFAULT 0,
   `payload` TEXT NOT NULL,
   `created_at` DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP,
   `processed` TINYINT NOT NULL DEFAULT 0,
@@ -27,6 +28,7 @@ CREATE TABLE `gm_discord_inbox` (
   `result` MEDIUMTEXT NULL,
   PRIMARY KEY (`id`),
   KEY `idx_processed` (`processed`),
+  KEY `idx_pending_lane` (`processed`, `lane`, `id`),
   KEY `idx_discord_user_id` (`discord_user_id`)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
 
@@ -34,13 +36,15 @@ DROP TABLE IF EXISTS `gm_discord_outbox`;
 CREATE TABLE `gm_discord_outbox` (
   `id` INT UNSIGNED NOT NULL AUTO_INCREMENT,
   `event_type` VARCHAR(32) NOT NULL,
+  `ticket_id` INT UNSIGNED NOT NULL DEFAULT 0,
   `payload` MEDIUMTEXT NOT NULL,
   `created_at` DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP,
   `dispatched` TINYINT NOT NULL DEFAULT 0,
   `dispatched_at` DATETIME NULL,
   PRIMARY KEY (`id`),
   KEY `idx_dispatched` (`dispatched`),
-  KEY `idx_event_type` (`event_type`)
+  KEY `idx_event_type` (`event_type`),
+  KEY `idx_ticket_id` (`ticket_id`, `id`)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
 
 DROP TABLE IF EXISTS `gm_discord_audit`;
@@ -71,6 +75,23 @@ CREATE TABLE `gm_discord_ticket_room` (
   UNIQUE KEY `uniq_channel_id` (`channel_id`)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
 
+DROP TABLE IF EXISTS `gm_discord_ticket_thread`;
+CREATE TABLE `gm_discord_ticket_thread` (
+  `ticket_id` INT UNSIGNED NOT NULL,
+  `message_id` BIGINT UNSIGNED NOT NULL DEFAULT 0,
+  `thread_id` BIGINT UNSIGNED NOT NULL DEFAULT 0,
+  PRIMARY KEY (`ticket_id`),
+  KEY `idx_thread_id` (`thread_id`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
+
+DROP TABLE IF EXISTS `gm_discord_bot_state`;
+CREATE TABLE `gm_discord_bot_state` (
+  `name` VARCHAR(32) NOT NULL,
+  `value` VARCHAR(255) NOT NULL DEFAULT '',
+  `updated_at` DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
+  PRIMARY KEY (`name`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
+
 DROP TABLE IF EXISTS `gm_discord_whisper_session`;
 CREATE TABLE `gm_discord_whisper_session` (
   `player_guid` BIGINT UNSIGNED NOT NULL,
@@ -81,3 +102,21 @@ CREATE TABLE `gm_discord_whisper_session` (
   KEY `idx_discord_user_id` (`discord_user_id`),
   KEY `idx_gm_name` (`gm_name`)
 ) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
+
+DROP TABLE IF EXISTS `gm_discord_ticket_stats`;
+CREATE TABLE `gm_discord_ticket_stats` (
+  `id` INT UNSIGNED NOT NULL AUTO_INCREMENT,
+  `period_start` DATETIME NOT NULL,
+  `period_end` DATETIME NOT NULL,
+  `scope` VARCHAR(8) NOT NULL,
+  `scope_key` VARCHAR(32) NOT NULL,
+  `metric` VARCHAR(16) NOT NULL,
+  `samples` INT UNSIGNED NOT NULL,
+  `p50_seconds` INT UNSIGNED NOT NULL,
+  `p90_seconds` INT UNSIGNED NOT NULL,
+  `p99_seconds` INT UNSIGNED NOT NULL,
+  `max_seconds` INT UNSIGNED NOT NULL,
+  PRIMARY KEY (`id`),
+  KEY `idx_period` (`period_start`),
+  KEY `idx_scope` (`scope`, `scope_key`, `metric`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
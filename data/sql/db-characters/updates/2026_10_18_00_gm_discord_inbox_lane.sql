@@ -0,0 +1,24 @@
+-- GM Discord: inbox priority lanes (gm_discord_inbox.lane, idx_pending_lane)
+-- For installs created before lanes existed. Safe to run more than once.
+
+DROP PROCEDURE IF EXISTS `gm_discord_upgrade_inbox_lane`;
+DELIMITER //
+CREATE PROCEDURE `gm_discord_upgrade_inbox_lane`()
+BEGIN
+  IF NOT EXISTS (SELECT 1 FROM information_schema.COLUMNS WHERE TABLE_SCHEMA = DATABASE()
+      AND TABLE_NAME = 'gm_discord_inbox' AND COLUMN_NAME = 'lane') THEN
+    ALTER TABLE `gm_discord_inbox` ADD COLUMN `lane` TINYINT UNSIGNED NOT NULL DEFAULT 0 AFTER `action`;
+    -- Pending rows keep their place: auth = 1, command = 2, the rest 0.
+    UPDATE `gm_discord_inbox` SET `lane` = 1 WHERE `processed` = 0 AND `action` = 'auth';
+    UPDATE `gm_discord_inbox` SET `lane` = 2 WHERE `processed` = 0 AND `action` = 'command';
+  END IF;
+
+  IF NOT EXISTS (SELECT 1 FROM information_schema.STATISTICS WHERE TABLE_SCHEMA = DATABASE()
+      AND TABLE_NAME = 'gm_discord_inbox' AND INDEX_NAME = 'idx_pending_lane') THEN
+    ALTER TABLE `gm_discord_inbox` ADD KEY `idx_pending_lane` (`processed`, `lane`, `id`);
+  END IF;
+END//
+DELIMITER ;
+
+CALL `gm_discord_upgrade_inbox_lane`();
+DROP PROCEDURE IF EXISTS `gm_discord_upgrade_inbox_lane`;
@@ -0,0 +1,22 @@
+-- GM Discord: per-ticket outbox lookups (gm_discord_outbox.ticket_id, idx_ticket_id)
+-- For installs created before transcripts existed. Safe to run more than once.
+-- Rows written before the upgrade keep ticket_id 0 and stay out of transcripts.
+
+DROP PROCEDURE IF EXISTS `gm_discord_upgrade_outbox_ticket_id`;
+DELIMITER //
+CREATE PROCEDURE `gm_discord_upgrade_outbox_ticket_id`()
+BEGIN
+  IF NOT EXISTS (SELECT 1 FROM information_schema.COLUMNS WHERE TABLE_SCHEMA = DATABASE()
+      AND TABLE_NAME = 'gm_discord_outbox' AND COLUMN_NAME = 'ticket_id') THEN
+    ALTER TABLE `gm_discord_outbox` ADD COLUMN `ticket_id` INT UNSIGNED NOT NULL DEFAULT 0 AFTER `event_type`;
+  END IF;
+
+  IF NOT EXISTS (SELECT 1 FROM information_schema.STATISTICS WHERE TABLE_SCHEMA = DATABASE()
+      AND TABLE_NAME = 'gm_discord_outbox' AND INDEX_NAME = 'idx_ticket_id') THEN
+    ALTER TABLE `gm_discord_outbox` ADD KEY `idx_ticket_id` (`ticket_id`, `id`);
+  END IF;
+END//
+DELIMITER ;
+
+CALL `gm_discord_upgrade_outbox_ticket_id`();
+DROP PROCEDURE IF EXISTS `gm_discord_upgrade_outbox_ticket_id`;
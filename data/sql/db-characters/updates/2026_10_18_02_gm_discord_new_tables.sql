@@ -0,0 +1,34 @@
+-- GM Discord: tables added after the first release
+-- (ticket SLA rollups, ticket message/thread links, bot state). Safe to run more than once.
+
+CREATE TABLE IF NOT EXISTS `gm_discord_ticket_stats` (
+  `id` INT UNSIGNED NOT NULL AUTO_INCREMENT,
+  `period_start` DATETIME NOT NULL,
+  `period_end` DATETIME NOT NULL,
+  `scope` VARCHAR(8) NOT NULL,
+  `scope_key` VARCHAR(32) NOT NULL,
+  `metric` VARCHAR(16) NOT NULL,
+  `samples` INT UNSIGNED NOT NULL,
+  `p50_seconds` INT UNSIGNED NOT NULL,
+  `p90_seconds` INT UNSIGNED NOT NULL,
+  `p99_seconds` INT UNSIGNED NOT NULL,
+  `max_seconds` INT UNSIGNED NOT NULL,
+  PRIMARY KEY (`id`),
+  KEY `idx_period` (`period_start`),
+  KEY `idx_scope` (`scope`, `scope_key`, `metric`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
+
+CREATE TABLE IF NOT EXISTS `gm_discord_ticket_thread` (
+  `ticket_id` INT UNSIGNED NOT NULL,
+  `message_id` BIGINT UNSIGNED NOT NULL DEFAULT 0,
+  `thread_id` BIGINT UNSIGNED NOT NULL DEFAULT 0,
+  PRIMARY KEY (`ticket_id`),
+  KEY `idx_thread_id` (`thread_id`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
+
+CREATE TABLE IF NOT EXISTS `gm_discord_bot_state` (
+  `name` VARCHAR(32) NOT NULL,
+  `value` VARCHAR(255) NOT NULL DEFAULT '',
+  `updated_at` DATETIME NOT NULL DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
+  PRIMARY KEY (`name`)
+) ENGINE=InnoDB DEFAULT CHARSET=utf8mb4;
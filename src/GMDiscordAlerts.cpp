@@ -0,0 +1,319 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GMDiscordAlerts.h"
+#include "GMDiscordKeywords.h"
+
+#include "CharacterCache.h"
+#include "Config.h"
+#include "Log.h"
+#include "ObjectGuid.h"
+#include "StringFormat.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+
+namespace GMDiscord
+{
+    namespace
+    {
+        struct AlertDefinition
+        {
+            char const* configName;
+            char const* eventName;
+            uint64_t minValue;
+            uint64_t maxValue;
+            uint32_t count;
+            uint32_t windowSeconds;
+        };
+
+        constexpr AlertDefinition ALERT_DEFINITIONS[MAX_ALERT_KINDS] =
+        {
+            { "GoldGain",      "gold_gain",      10000000, UINT64_MAX, 1,  0  }, // value: copper gained at once
+            { "GmCommand",     "gm_command",     2,        UINT64_MAX, 1,  0  }, // value: account security
+            { "LevelSpeedrun", "level_speedrun", 0,        259200,     1,  0  }, // value: played seconds
+            { "MassMail",      "mass_mail",      0,        UINT64_MAX, 20, 60 }, // value: unused
+            { "KeywordWhisper", "keyword_whisper", 0,      UINT64_MAX, 1,  0  }, // value: unused, aux: keyword categories
+        };
+
+        static std::string EscapeJson(std::string_view input)
+        {
+            std::string out;
+            out.reserve(input.size() + 8);
+            for (char ch : input)
+            {
+                switch (ch)
+                {
+                    case '\\': out += "\\\\"; break;
+                    case '"': out += "\\\""; break;
+                    case '\n': out += "\\n"; break;
+                    case '\r': out += "\\r"; break;
+                    case '\t': out += "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(ch) < 0x20)
+                            out += ' ';
+                        else
+                            out += ch;
+                        break;
+                }
+            }
+            return out;
+        }
+
+        static bool StartsWithNoCase(std::string_view value, std::string_view prefix)
+        {
+            return value.size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), value.begin(), [](char a, char b)
+            {
+                return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+            });
+        }
+
+        static std::string FormatMoney(uint64_t copper)
+        {
+            return Acore::StringFormat("{}g {}s {}c", copper / 10000, copper / 100 % 100, copper % 100);
+        }
+
+        static std::string GetActorName(uint64_t guid)
+        {
+            std::string name;
+            if (!sCharacterCache->GetCharacterNameByGuid(ObjectGuid(guid), name))
+                name = Acore::StringFormat("guid {}", ObjectGuid(guid).GetCounter());
+            return name;
+        }
+    }
+
+    AlertPipeline& AlertPipeline::Instance()
+    {
+        static AlertPipeline instance;
+        return instance;
+    }
+
+    void AlertPipeline::LoadConfig()
+    {
+        auto rules = std::make_unique<Rules>();
+        rules->flushIntervalMs = std::max<uint32>(100, sConfigMgr->GetOption<uint32>("GMDiscord.Alert.FlushIntervalMs", 1000));
+
+        uint32_t mask = 0;
+        for (uint8_t kind = 0; kind < MAX_ALERT_KINDS; ++kind)
+        {
+            AlertDefinition const& definition = ALERT_DEFINITIONS[kind];
+            std::string prefix = Acore::StringFormat("GMDiscord.Alert.{}.", definition.configName);
+            Rule& rule = rules->rules[kind];
+            rule.enabled = sConfigMgr->GetOption<bool>(prefix + "Enable", false);
+            rule.minValue = sConfigMgr->GetOption<uint64>(prefix + "MinValue", definition.minValue);
+            rule.maxValue = sConfigMgr->GetOption<uint64>(prefix + "MaxValue", definition.maxValue);
+            rule.count = std::max<uint32>(1, sConfigMgr->GetOption<uint32>(prefix + "Count", definition.count));
+            rule.windowSeconds = sConfigMgr->GetOption<uint32>(prefix + "WindowSeconds", definition.windowSeconds);
+
+            std::string match = sConfigMgr->GetOption<std::string>(prefix + "Match", "");
+            for (size_t start = 0; start < match.size();)
+            {
+                size_t end = match.find(',', start);
+                if (end == std::string::npos)
+                    end = match.size();
+                std::string_view item(match.data() + start, end - start);
+                while (!item.empty() && std::isspace(static_cast<unsigned char>(item.front())))
+                    item.remove_prefix(1);
+                while (!item.empty() && std::isspace(static_cast<unsigned char>(item.back())))
+                    item.remove_suffix(1);
+                if (!item.empty())
+                    rule.match.emplace_back(item);
+                start = end + 1;
+            }
+
+            if (rule.enabled)
+                mask |= 1u << kind;
+        }
+
+        _rules.Publish(std::move(rules));
+        g_AlertMask.store(mask, std::memory_order_relaxed);
+    }
+
+    AlertPipeline::ThreadBuffer& AlertPipeline::GetThreadBuffer()
+    {
+        thread_local std::shared_ptr<ThreadBuffer> buffer = [this]()
+        {
+            auto created = std::make_shared<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock(_registryMutex);
+            _buffers.push_back(created);
+            return created;
+        }();
+        return *buffer;
+    }
+
+    void AlertPipeline::Push(AlertKind kind, uint64_t actorGuid, uint64_t value, uint32_t aux, std::string_view detail)
+    {
+        Rule const& rule = _rules.Get().rules[kind];
+        if (!rule.enabled || value < rule.minValue || value > rule.maxValue)
+            return;
+
+        ThreadBuffer& buffer = GetThreadBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        if (buffer.events.size() >= MAX_BUFFERED)
+        {
+            ++buffer.dropped;
+            return;
+        }
+
+        Event& event = buffer.events.emplace_back();
+        event.actorGuid = actorGuid;
+        event.value = value;
+        event.aux = aux;
+        event.at = static_cast<uint32_t>(std::time(nullptr));
+        event.kind = kind;
+        event.detailLength = static_cast<uint8_t>(std::min(detail.size(), MAX_DETAIL));
+        std::memcpy(event.detail, detail.data(), event.detailLength);
+    }
+
+    bool AlertPipeline::Matches(Rule const& rule, Event const& event)
+    {
+        if (!rule.enabled || event.value < rule.minValue || event.value > rule.maxValue)
+            return false;
+
+        if (!rule.match.empty())
+        {
+            std::string_view detail(event.detail, event.detailLength);
+            if (std::none_of(rule.match.begin(), rule.match.end(), [detail](std::string const& prefix) { return StartsWithNoCase(detail, prefix); }))
+                return false;
+        }
+
+        if (rule.count <= 1)
+            return true;
+
+        auto& windows = _windows[event.kind];
+        std::deque<uint32_t>& times = windows[event.actorGuid];
+        times.push_back(event.at);
+        while (!times.empty() && event.at - times.front() > rule.windowSeconds)
+            times.pop_front();
+        if (times.size() < rule.count)
+            return false;
+
+        // Fire once per burst.
+        windows.erase(event.actorGuid);
+        return true;
+    }
+
+    std::vector<std::string> AlertPipeline::Flush(uint64_t now)
+    {
+        std::vector<Event> events;
+        {
+            std::lock_guard<std::mutex> registryLock(_registryMutex);
+            for (auto it = _buffers.begin(); it != _buffers.end();)
+            {
+                ThreadBuffer& buffer = **it;
+                {
+                    std::lock_guard<std::mutex> lock(buffer.mutex);
+                    events.insert(events.end(), buffer.events.begin(), buffer.events.end());
+                    buffer.events.clear();
+                    _dropped += buffer.dropped;
+                    buffer.dropped = 0;
+                }
+
+                // The owning thread has exited.
+                if (it->use_count() == 1)
+                    it = _buffers.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        if (_dropped)
+        {
+            LOG_WARN("module.gm_discord", "Alert buffers overflowed; {} events dropped.", _dropped);
+            _dropped = 0;
+        }
+
+        // Forget actors whose newest event has left the window; one-off
+        // actors would otherwise keep their entry for the life of the process.
+        Rules const& rules = _rules.Get();
+        for (size_t kind = 0; kind < MAX_ALERT_KINDS; ++kind)
+        {
+            Rule const& rule = rules.rules[kind];
+            auto& windows = _windows[kind];
+            for (auto it = windows.begin(); it != windows.end();)
+            {
+                if (rule.count <= 1 || it->second.empty() || (now > it->second.back() && now - it->second.back() > rule.windowSeconds))
+                    it = windows.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        std::vector<std::string> payloads;
+        if (events.empty())
+            return payloads;
+
+        std::string summary;
+        std::string alerts;
+        size_t batched = 0;
+        auto finishBatch = [&]()
+        {
+            payloads.push_back(Acore::StringFormat(R"({{"event":"alert","summary":"{}","alerts":[{}],"timestamp":{}}})",
+                EscapeJson(summary), alerts, now));
+            summary.clear();
+            alerts.clear();
+            batched = 0;
+        };
+
+        for (Event const& event : events)
+        {
+            Rule const& rule = rules.rules[event.kind];
+            if (!Matches(rule, event))
+                continue;
+
+            std::string actor = GetActorName(event.actorGuid);
+            std::string_view detail(event.detail, event.detailLength);
+            switch (event.kind)
+            {
+                case ALERT_GOLD_GAIN:
+                    summary += Acore::StringFormat("Gold: **{}** gained {} at once\n", actor, FormatMoney(event.value));
+                    break;
+                case ALERT_GM_COMMAND:
+                    summary += Acore::StringFormat("GM command: **{}** ran `{}`\n", actor, detail);
+                    break;
+                case ALERT_LEVEL_SPEEDRUN:
+                    summary += Acore::StringFormat("Level: **{}** reached level {} after {}h {}m played\n",
+                        actor, event.aux, event.value / 3600, event.value / 60 % 60);
+                    break;
+                case ALERT_MASS_MAIL:
+                    summary += Acore::StringFormat("Mail: **{}** sent {} mails within {}s\n", actor, rule.count, rule.windowSeconds);
+                    break;
+                case ALERT_KEYWORD_WHISPER:
+                    summary += Acore::StringFormat("Keywords: **{}** whispered [{}] `{}`\n", actor,
+                        KeywordMatcher::Instance().FormatCategories(event.aux), detail);
+                    break;
+                default:
+                    break;
+            }
+
+            if (!alerts.empty())
+                alerts += ',';
+            alerts += Acore::StringFormat(R"({{"kind":"{}","actor":"{}","actorGuid":{},"value":{},"aux":{},"detail":"{}","at":{}}})",
+                ALERT_DEFINITIONS[event.kind].eventName, EscapeJson(actor), event.actorGuid, event.value, event.aux,
+                EscapeJson(detail), event.at);
+
+            if (++batched == MAX_BATCH)
+                finishBatch();
+        }
+
+        if (batched)
+            finishBatch();
+        return payloads;
+    }
+}
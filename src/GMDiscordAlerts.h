@@ -0,0 +1,136 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_ALERTS_H
+#define MOD_GM_DISCORD_ALERTS_H
+
+#include "GMDiscordSettings.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace GMDiscord
+{
+    enum AlertKind : uint8_t
+    {
+        ALERT_GOLD_GAIN       = 0,
+        ALERT_GM_COMMAND      = 1,
+        ALERT_LEVEL_SPEEDRUN  = 2,
+        ALERT_MASS_MAIL       = 3,
+        ALERT_KEYWORD_WHISPER = 4,
+        MAX_ALERT_KINDS
+    };
+
+    // Bit per enabled AlertKind. Hooks test it before doing anything else,
+    // so a disabled alert costs one load and one branch.
+    inline std::atomic<uint32_t> g_AlertMask{0};
+
+    inline bool IsAlertEnabled(AlertKind kind)
+    {
+        return g_AlertMask.load(std::memory_order_relaxed) & (1u << kind);
+    }
+
+    // Game-event alerts. Hooks push compact records into a buffer owned by
+    // the calling thread; the world thread periodically collects them and
+    // runs each kind's rule (compiled from GMDiscord.Alert.<Name>.*):
+    //
+    //   MinValue/MaxValue  range the event value must fall in
+    //   Match              comma-separated, case-insensitive prefixes of
+    //                      the detail text (empty = any)
+    //   Count/WindowSeconds  fire once an actor has Count matching events
+    //                      within the window
+    //
+    // Names are resolved and JSON built only for events that match.
+    class AlertPipeline
+    {
+    public:
+        static AlertPipeline& Instance();
+
+        void LoadConfig();
+        uint32_t GetFlushIntervalMs() const { return _rules.Get().flushIntervalMs; }
+
+        // Any thread. The value range is checked here so out-of-range events
+        // are never buffered.
+        void Push(AlertKind kind, uint64_t actorGuid, uint64_t value, uint32_t aux = 0, std::string_view detail = { });
+
+        // World thread. One outbox payload per batch of matches.
+        std::vector<std::string> Flush(uint64_t now);
+
+    private:
+        static constexpr size_t MAX_DETAIL = 63;
+        static constexpr size_t MAX_BUFFERED = 4096;
+        static constexpr size_t MAX_BATCH = 20;
+
+        struct Event
+        {
+            uint64_t actorGuid;
+            uint64_t value;
+            uint32_t aux;
+            uint32_t at;
+            AlertKind kind;
+            uint8_t detailLength;
+            char detail[MAX_DETAIL];
+        };
+
+        struct Rule
+        {
+            bool enabled = false;
+            uint64_t minValue = 0;
+            uint64_t maxValue = UINT64_MAX;
+            uint32_t count = 1;
+            uint32_t windowSeconds = 0;
+            std::vector<std::string> match;
+        };
+
+        struct Rules
+        {
+            std::array<Rule, MAX_ALERT_KINDS> rules;
+            uint32_t flushIntervalMs = 1000;
+        };
+
+        struct ThreadBuffer
+        {
+            std::mutex mutex;
+            std::vector<Event> events;
+            uint64_t dropped = 0;
+        };
+
+        AlertPipeline() = default;
+
+        ThreadBuffer& GetThreadBuffer();
+        bool Matches(Rule const& rule, Event const& event);
+
+        SettingsSnapshot<Rules> _rules;
+
+        std::mutex _registryMutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> _buffers;
+
+        // World thread only: recent event times per actor, for Count rules.
+        std::array<std::unordered_map<uint64_t, std::deque<uint32_t>>, MAX_ALERT_KINDS> _windows;
+        uint64_t _dropped = 0;
+    };
+}
+
+#endif
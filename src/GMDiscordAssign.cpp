@@ -0,0 +1,316 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GMDiscordAssign.h"
+#include "GMDiscordDatabase.h"
+#include "GMDiscordPresence.h"
+
+#include "AccountMgr.h"
+#include "CharacterCache.h"
+#include "Config.h"
+#include "DatabaseEnv.h"
+#include "Log.h"
+#include "ObjectGuid.h"
+
+namespace GMDiscord
+{
+    AutoAssigner& AutoAssigner::Instance()
+    {
+        static AutoAssigner instance;
+        return instance;
+    }
+
+    void AutoAssigner::LoadConfig()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _enabled = sConfigMgr->GetOption<bool>("GMDiscord.AutoAssign.Enable", false);
+        _maxOpenPerGm = sConfigMgr->GetOption<uint32>("GMDiscord.AutoAssign.MaxOpenPerGm", 0);
+
+        for (auto& [guid, gm] : _gms)
+            Refresh(gm);
+    }
+
+    void AutoAssigner::Load()
+    {
+        if (!IsEnabled())
+            return;
+
+        QueryResult links = ModuleDB().Query(
+            "SELECT account_id, gm_name FROM gm_discord_link WHERE verified=1 AND gm_name IS NOT NULL AND gm_name <> ''");
+        if (links)
+        {
+            do
+            {
+                Field* fields = links->Fetch();
+                uint32 accountId = fields[0].Get<uint32>();
+                RegisterGm(accountId, fields[1].Get<std::string>(), AccountMgr::GetSecurity(accountId));
+            } while (links->NextRow());
+        }
+
+        QueryResult assigned = ModuleDB().Query("SELECT id, assignedTo FROM gm_ticket WHERE type=0 AND assignedTo<>0");
+        if (assigned)
+        {
+            do
+            {
+                Field* fields = assigned->Fetch();
+                OnTicketAssigned(fields[0].Get<uint32>(), ObjectGuid::Create<HighGuid::Player>(fields[1].Get<uint32>()).GetRawValue());
+            } while (assigned->NextRow());
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        LOG_INFO("module.gm_discord", "Auto-assign tracking {} linked GMs and {} assigned tickets.", _gms.size(), _assignments.size());
+    }
+
+    bool AutoAssigner::IsEnabled() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _enabled;
+    }
+
+    void AutoAssigner::SetRequiredSecurity(uint32_t security)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _requiredSecurity = security;
+        for (auto& [guid, gm] : _gms)
+            Refresh(gm);
+    }
+
+    void AutoAssigner::RegisterGm(uint32_t accountId, std::string const& gmName, uint32_t security)
+    {
+        ObjectGuid guid = sCharacterCache->GetCharacterGuidByName(gmName);
+        if (!guid)
+            return;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        // Re-linking to another character drops the old entry; the same
+        // character keeps its load and presence across config reloads.
+        EraseAccount(accountId, guid.GetRawValue());
+
+        Gm& gm = _gms[guid.GetRawValue()];
+        gm.guid = guid.GetRawValue();
+        gm.accountId = accountId;
+        gm.security = security;
+        _guidByAccount[accountId] = gm.guid;
+        Refresh(gm);
+    }
+
+    void AutoAssigner::UnregisterAccount(uint32_t accountId)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        EraseAccount(accountId, 0);
+    }
+
+    void AutoAssigner::EraseAccount(uint32_t accountId, uint64_t keepGuid)
+    {
+        auto link = _guidByAccount.find(accountId);
+        if (link == _guidByAccount.end() || link->second == keepGuid)
+            return;
+
+        uint64_t guid = link->second;
+        _guidByAccount.erase(link);
+        auto it = _gms.find(guid);
+        if (it == _gms.end())
+            return;
+
+        HeapRemove(it->second);
+        // Tickets stay assigned in game; forget them here so counts don't leak.
+        for (auto assignment = _assignments.begin(); assignment != _assignments.end();)
+        {
+            if (assignment->second == guid)
+                assignment = _assignments.erase(assignment);
+            else
+                ++assignment;
+        }
+        _gms.erase(it);
+    }
+
+    void AutoAssigner::OnPresenceChanged(uint32_t accountId)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto link = _guidByAccount.find(accountId);
+        if (link == _guidByAccount.end())
+            return;
+
+        auto it = _gms.find(link->second);
+        if (it != _gms.end())
+            Refresh(it->second);
+    }
+
+    void AutoAssigner::OnTicketAssigned(uint32_t ticketId, uint64_t gmGuid)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto [it, inserted] = _assignments.try_emplace(ticketId, gmGuid);
+        if (!inserted)
+        {
+            if (it->second == gmGuid)
+                return;
+
+            Adjust(it->second, -1);
+            it->second = gmGuid;
+        }
+
+        Adjust(gmGuid, 1);
+    }
+
+    void AutoAssigner::OnTicketUnassigned(uint32_t ticketId)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _assignments.find(ticketId);
+        if (it == _assignments.end())
+            return;
+
+        Adjust(it->second, -1);
+        _assignments.erase(it);
+    }
+
+    bool AutoAssigner::Pick(uint64_t& gmGuid, uint32_t& security)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_enabled)
+            return false;
+
+        while (!_heap.empty())
+        {
+            Gm& top = *_heap.front();
+            if (!IsReachable(top))
+            {
+                HeapRemove(top);
+                continue;
+            }
+
+            if (_maxOpenPerGm && top.openTickets >= _maxOpenPerGm)
+                return false;
+
+            gmGuid = top.guid;
+            security = top.security;
+            // Ties go to whoever was assigned least recently.
+            top.assignSequence = ++_sequence;
+            HeapUpdate(top);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool AutoAssigner::IsReachable(Gm const& gm) const
+    {
+        return gm.security >= _requiredSecurity && GmPresence::Instance().IsReachable(gm.accountId);
+    }
+
+    void AutoAssigner::Refresh(Gm& gm)
+    {
+        bool reachable = _enabled && IsReachable(gm);
+        if (reachable && gm.heapIndex == NOT_IN_HEAP)
+            HeapInsert(gm);
+        else if (!reachable && gm.heapIndex != NOT_IN_HEAP)
+            HeapRemove(gm);
+    }
+
+    void AutoAssigner::Adjust(uint64_t gmGuid, int32_t delta)
+    {
+        auto it = _gms.find(gmGuid);
+        if (it == _gms.end())
+            return;
+
+        Gm& gm = it->second;
+        if (delta < 0 && gm.openTickets < uint32_t(-delta))
+            gm.openTickets = 0;
+        else
+            gm.openTickets += delta;
+
+        if (gm.heapIndex != NOT_IN_HEAP)
+            HeapUpdate(gm);
+    }
+
+    bool AutoAssigner::Less(size_t a, size_t b) const
+    {
+        Gm const& left = *_heap[a];
+        Gm const& right = *_heap[b];
+        if (left.openTickets != right.openTickets)
+            return left.openTickets < right.openTickets;
+        return left.assignSequence < right.assignSequence;
+    }
+
+    void AutoAssigner::Swap(size_t a, size_t b)
+    {
+        std::swap(_heap[a], _heap[b]);
+        _heap[a]->heapIndex = a;
+        _heap[b]->heapIndex = b;
+    }
+
+    void AutoAssigner::SiftUp(size_t index)
+    {
+        while (index > 0)
+        {
+            size_t parent = (index - 1) / 2;
+            if (!Less(index, parent))
+                break;
+            Swap(index, parent);
+            index = parent;
+        }
+    }
+
+    void AutoAssigner::SiftDown(size_t index)
+    {
+        for (;;)
+        {
+            size_t smallest = index;
+            size_t left = index * 2 + 1;
+            size_t right = left + 1;
+            if (left < _heap.size() && Less(left, smallest))
+                smallest = left;
+            if (right < _heap.size() && Less(right, smallest))
+                smallest = right;
+            if (smallest == index)
+                return;
+            Swap(index, smallest);
+            index = smallest;
+        }
+    }
+
+    void AutoAssigner::HeapInsert(Gm& gm)
+    {
+        gm.heapIndex = _heap.size();
+        _heap.push_back(&gm);
+        SiftUp(gm.heapIndex);
+    }
+
+    void AutoAssigner::HeapRemove(Gm& gm)
+    {
+        size_t index = gm.heapIndex;
+        if (index == NOT_IN_HEAP)
+            return;
+
+        size_t last = _heap.size() - 1;
+        if (index != last)
+            Swap(index, last);
+        _heap.pop_back();
+        gm.heapIndex = NOT_IN_HEAP;
+
+        if (index < _heap.size())
+        {
+            SiftUp(index);
+            SiftDown(_heap[index]->heapIndex);
+        }
+    }
+
+    void AutoAssigner::HeapUpdate(Gm& gm)
+    {
+        SiftUp(gm.heapIndex);
+        SiftDown(gm.heapIndex);
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_ASSIGN_H
+#define MOD_GM_DISCORD_ASSIGN_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace GMDiscord
+{
+    // Opt-in least-loaded ticket assignment. Keeps, for every linked GM, the
+    // number of open tickets assigned to them. Reachability comes from
+    // GmPresence (in game, or on Discord with a ticket role). Reachable GMs
+    // sit in an indexed min-heap ordered by load, so picking and every load
+    // or presence change is O(log n). Discord presence expires lazily when a
+    // stale GM reaches the top of the heap.
+    class AutoAssigner
+    {
+    public:
+        static AutoAssigner& Instance();
+
+        void LoadConfig();
+        // Reads linked GMs and current assignments; call from the world thread.
+        void Load();
+
+        bool IsEnabled() const;
+        void SetRequiredSecurity(uint32_t security);
+
+        void RegisterGm(uint32_t accountId, std::string const& gmName, uint32_t security);
+        void UnregisterAccount(uint32_t accountId);
+
+        // Call after GmPresence changes for the account.
+        void OnPresenceChanged(uint32_t accountId);
+
+        void OnTicketAssigned(uint32_t ticketId, uint64_t gmGuid);
+        void OnTicketUnassigned(uint32_t ticketId);
+
+        // Least-loaded reachable GM, if any is under the per-GM cap.
+        bool Pick(uint64_t& gmGuid, uint32_t& security);
+
+    private:
+        static constexpr size_t NOT_IN_HEAP = SIZE_MAX;
+
+        struct Gm
+        {
+            uint64_t guid = 0;
+            uint32_t accountId = 0;
+            uint32_t security = 0;
+            uint32_t openTickets = 0;
+            uint64_t assignSequence = 0;
+            size_t heapIndex = NOT_IN_HEAP;
+        };
+
+        AutoAssigner() = default;
+
+        void EraseAccount(uint32_t accountId, uint64_t keepGuid);
+        bool IsReachable(Gm const& gm) const;
+        void Refresh(Gm& gm);
+        void Adjust(uint64_t gmGuid, int32_t delta);
+
+        bool Less(size_t a, size_t b) const;
+        void Swap(size_t a, size_t b);
+        void SiftUp(size_t index);
+        void SiftDown(size_t index);
+        void HeapInsert(Gm& gm);
+        void HeapRemove(Gm& gm);
+        void HeapUpdate(Gm& gm);
+
+        mutable std::mutex _mutex;
+        bool _enabled = false;
+        uint32_t _maxOpenPerGm = 0;
+        uint32_t _requiredSecurity = 2;
+        uint64_t _sequence = 0;
+
+        std::unordered_map<uint64_t, Gm> _gms;
+        std::unordered_map<uint32_t, uint64_t> _guidByAccount;
+        std::unordered_map<uint32_t, uint64_t> _assignments;
+        std::vector<Gm*> _heap;
+    };
+}
+
+#endif
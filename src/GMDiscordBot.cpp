@@ -16,6 +16,19 @@
  */
 
 #include "GMDiscordBot.h"
+#include "GMDiscordAssign.h"
+#include "GMDiscordConversation.h"
+#include "GMDiscordDatabase.h"
+#include "GMDiscordInbox.h"
+#include "GMDiscordLogRelay.h"
+#include "GMDiscordMetrics.h"
+#include "GMDiscordPresence.h"
+#include "GMDiscordSearch.h"
+#include "GMDiscordSendQueue.h"
+#include "GMDiscordSpill.h"
+#include "GMDiscordTicketLinks.h"
+#include "GMDiscordTicketStats.h"
+#include "GMDiscordTranscript.h"
 
 #include "Config.h"
 #include "DatabaseEnv.h"
@@ -28,6 +41,12 @@
 
 #include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -46,6 +65,13 @@ namespace GMDiscord
     namespace
     {
         constexpr size_t DISCORD_MESSAGE_LIMIT = 1900;
+        constexpr size_t DISCORD_EMBED_FIELD_LIMIT = 1024;
+        constexpr size_t DISCORD_CHOICE_NAME_LIMIT = 100;
+        constexpr size_t DISCORD_MAX_CHOICES = 25;
+        constexpr size_t DISCORD_MAX_EMBEDS = 10;
+        constexpr uint64_t DISCORD_MESSAGE_PAGE = 100;
+        constexpr size_t DISCORD_EMBED_TOTAL_LIMIT = 6000;
+        constexpr char STATUS_EMBED_TITLE[] = "Server Status";
 
         static std::string EscapeSql(std::string const& input)
         {
@@ -115,7 +141,7 @@ namespace GMDiscord
         static bool TryGetCharacterContext(std::string const& playerName, uint32& level, uint32& classId)
         {
             std::string playerEsc = EscapeSql(playerName);
-            QueryResult result = CharacterDatabase.Query(Acore::StringFormat(
+            QueryResult result = ModuleReadDB().Query(Acore::StringFormat(
                 "SELECT level, class FROM characters WHERE name='{}' LIMIT 1",
                 playerEsc));
 
@@ -286,9 +312,10 @@ namespace GMDiscord
             return out;
         }
 
-        static std::unordered_map<uint64_t, std::unordered_set<std::string>> ParseRoleMappings(std::string const& value)
+        static RoleCategoryTable ParseRoleMappings(std::string const& value)
         {
-            std::unordered_map<uint64_t, std::unordered_set<std::string>> out;
+            RoleCategoryTable out;
+            std::vector<std::pair<uint64_t, uint32_t>> masks;
             for (std::string const& entry : Split(value, ';'))
             {
                 size_t sep = entry.find(':');
@@ -310,11 +337,33 @@ namespace GMDiscord
                     continue;
                 }
 
-                auto& setRef = out[roleId];
+                uint32_t mask = 0;
                 for (std::string const& cat : Split(categoriesStr, ','))
-                    setRef.insert(ToLower(cat));
+                {
+                    std::string name = ToLower(cat);
+                    auto it = std::find(out.categories.begin(), out.categories.end(), name);
+                    if (it == out.categories.end())
+                    {
+                        if (out.categories.size() == RoleCategoryTable::MAX_CATEGORIES)
+                        {
+                            LOG_ERROR("module.gm_discord", "GMDiscord.Bot.RoleMappings: category {} ignored, at most {} categories.",
+                                name, RoleCategoryTable::MAX_CATEGORIES);
+                            continue;
+                        }
+                        it = out.categories.insert(out.categories.end(), name);
+                    }
+                    mask |= 1u << (it - out.categories.begin());
+                }
+
+                // A role listed twice gets the union of its categories.
+                auto existing = std::find_if(masks.begin(), masks.end(), [roleId](auto const& entry) { return entry.first == roleId; });
+                if (existing != masks.end())
+                    existing->second |= mask;
+                else
+                    masks.emplace_back(roleId, mask);
             }
 
+            out.roleMasks = SortedIdTable<uint32_t>(std::move(masks));
             return out;
         }
 
@@ -384,52 +433,72 @@ namespace GMDiscord
             }
         }
 
-        static bool HasRoleForCategory(std::unordered_map<uint64_t, std::unordered_set<std::string>> const& roleMap,
+        static bool HasRoleForCategory(RoleCategoryTable const& roleMap,
             std::vector<dpp::snowflake> const& roles, std::string const& category)
         {
-            if (roleMap.empty())
+            if (roleMap.roleMasks.empty())
                 return true;
 
             std::string cat = ToLower(category);
+            auto it = std::find(roleMap.categories.begin(), roleMap.categories.end(), cat);
+            if (it == roleMap.categories.end())
+                return false;
+
+            uint32_t bit = 1u << (it - roleMap.categories.begin());
             for (dpp::snowflake roleId : roles)
             {
-                auto it = roleMap.find(static_cast<uint64_t>(roleId));
-                if (it != roleMap.end() && it->second.count(cat) > 0)
+                uint32_t const* mask = roleMap.roleMasks.Find(static_cast<uint64_t>(roleId));
+                if (mask && (*mask & bit))
                     return true;
             }
 
             return false;
         }
 
-        static bool FindJsonKeyStart(std::string const& payload, std::string const& key, size_t& pos)
+        // Every interaction refreshes the user's Discord presence for auto-assign.
+        static void NoteGmActivity(RoleCategoryTable const& roleMap,
+            dpp::interaction const& command)
         {
-            std::string needle = Acore::StringFormat("\"{}\":", key);
-            pos = payload.find(needle);
-            if (pos != std::string::npos)
-            {
-                pos += needle.size();
-                return true;
-            }
+            uint32 accountId = GmPresence::Instance().OnDiscordInteraction(command.usr.id,
+                HasRoleForCategory(roleMap, command.member.get_roles(), "ticket"));
+            if (accountId)
+                AutoAssigner::Instance().OnPresenceChanged(accountId);
+        }
 
-            std::string escapedNeedle = Acore::StringFormat("\\\"{}\\\":", key);
-            pos = payload.find(escapedNeedle);
-            if (pos != std::string::npos)
+        // Finds `quote key quote :` without building the needle; `quote` is
+        // either `"` or the escaped `\"` used by nested payloads.
+        static bool FindQuotedKey(std::string_view payload, std::string_view key, std::string_view quote, size_t& pos)
+        {
+            for (size_t at = payload.find(key); at != std::string_view::npos; at = payload.find(key, at + 1))
             {
-                pos += escapedNeedle.size();
+                if (at < quote.size() || payload.substr(at - quote.size(), quote.size()) != quote)
+                    continue;
+
+                size_t after = at + key.size();
+                if (payload.substr(after, quote.size()) != quote || payload.substr(after + quote.size(), 1) != ":")
+                    continue;
+
+                pos = after + quote.size() + 1;
                 return true;
             }
 
             return false;
         }
 
-        static bool ExtractJsonBlock(std::string const& payload, std::string const& key, std::string& out)
+        static bool FindJsonKeyStart(std::string_view payload, std::string_view key, size_t& pos)
+        {
+            return FindQuotedKey(payload, key, "\"", pos) || FindQuotedKey(payload, key, "\\\"", pos);
+        }
+
+        // Returns a view into `payload`; callers keep the payload alive.
+        static bool ExtractJsonBlock(std::string_view payload, std::string_view key, std::string_view& out)
         {
             size_t start = 0;
             if (!FindJsonKeyStart(payload, key, start))
                 return false;
 
             start = payload.find('{', start);
-            if (start == std::string::npos)
+            if (start == std::string_view::npos)
                 return false;
 
             int depth = 0;
@@ -475,7 +544,7 @@ namespace GMDiscord
             return false;
         }
 
-        static bool ExtractJsonString(std::string const& payload, std::string const& key, std::string& out)
+        static bool ExtractJsonString(std::string_view payload, std::string_view key, std::string& out)
         {
             size_t pos = 0;
             if (!FindJsonKeyStart(payload, key, pos))
@@ -533,7 +602,7 @@ namespace GMDiscord
             return false;
         }
 
-        static bool ExtractJsonNumber(std::string const& payload, std::string const& key, std::string& out)
+        static bool ExtractJsonNumber(std::string_view payload, std::string_view key, std::string_view& out)
         {
             size_t pos = 0;
             if (!FindJsonKeyStart(payload, key, pos))
@@ -543,50 +612,44 @@ namespace GMDiscord
                 ++pos;
 
             size_t end = payload.find_first_of(",}", pos);
-            if (end == std::string::npos)
+            if (end == std::string_view::npos)
                 return false;
 
-            out = Trim(payload.substr(pos, end - pos));
+            out = payload.substr(pos, end - pos);
+            while (!out.empty() && std::isspace(static_cast<unsigned char>(out.back())))
+                out.remove_suffix(1);
             return !out.empty();
         }
 
-        static bool ExtractJsonFloat(std::string const& payload, std::string const& key, float& out)
+        template <typename T>
+        static bool ExtractJsonArithmetic(std::string_view payload, std::string_view key, T& out)
         {
-            std::string number;
+            std::string_view number;
             if (!ExtractJsonNumber(payload, key, number))
                 return false;
 
-            try
-            {
-                out = std::stof(number);
-                return true;
-            }
-            catch (...)
-            {
+            T value{};
+            auto [ptr, ec] = std::from_chars(number.data(), number.data() + number.size(), value);
+            if (ec != std::errc() || ptr == number.data())
                 return false;
-            }
+
+            out = value;
+            return true;
         }
 
-        static bool ExtractJsonUint(std::string const& payload, std::string const& key, uint32& out)
+        static bool ExtractJsonFloat(std::string_view payload, std::string_view key, float& out)
         {
-            std::string number;
-            if (!ExtractJsonNumber(payload, key, number))
-                return false;
+            return ExtractJsonArithmetic(payload, key, out);
+        }
 
-            try
-            {
-                out = static_cast<uint32>(std::stoul(number));
-                return true;
-            }
-            catch (...)
-            {
-                return false;
-            }
+        static bool ExtractJsonUint(std::string_view payload, std::string_view key, uint32& out)
+        {
+            return ExtractJsonArithmetic(payload, key, out);
         }
 
-        static bool BuildTicketEmbed(std::string const& eventType, std::string const& payload, dpp::embed& embed)
+        static bool BuildTicketEmbed(std::string_view eventType, std::string_view payload, dpp::embed& embed)
         {
-            std::string ticketBlock;
+            std::string_view ticketBlock;
             if (!ExtractJsonBlock(payload, "ticket", ticketBlock))
                 return false;
 
@@ -597,6 +660,7 @@ namespace GMDiscord
             std::string assignedTo;
             std::string comment;
             std::string response;
+            std::string flags;
 
             ExtractJsonUint(ticketBlock, "id", id);
             ExtractJsonString(ticketBlock, "player", player);
@@ -605,6 +669,7 @@ namespace GMDiscord
             ExtractJsonString(ticketBlock, "assignedTo", assignedTo);
             ExtractJsonString(ticketBlock, "comment", comment);
             ExtractJsonString(ticketBlock, "response", response);
+            ExtractJsonString(ticketBlock, "flags", flags);
 
             if (player.empty())
                 player = "unknown";
@@ -619,6 +684,8 @@ namespace GMDiscord
 
             embed.add_field("Status", status, true);
             embed.add_field("Assigned", assignedTo, true);
+            if (!flags.empty())
+                embed.add_field("Flagged", flags, true);
 
             uint32 level = 0;
             uint32 classId = 0;
@@ -628,7 +695,7 @@ namespace GMDiscord
                 embed.add_field("Class", GetClassName(classId), true);
             }
 
-            std::string locationBlock;
+            std::string_view locationBlock;
             uint32 mapId = 0;
             float posX = 0.0f;
             float posY = 0.0f;
@@ -647,7 +714,9 @@ namespace GMDiscord
             if (!response.empty())
                 embed.add_field("Response", TruncateForDiscord(response), false);
 
-            if (eventType == "ticket_close" || eventType == "ticket_resolve")
+            if (eventType == "ticket_escalation")
+                embed.set_color(0xF2994A);
+            else if (eventType == "ticket_close" || eventType == "ticket_resolve")
                 embed.set_color(0xFF5555);
             else if (eventType == "ticket_update" || eventType == "ticket_status")
                 embed.set_color(0xF2C94C);
@@ -657,20 +726,22 @@ namespace GMDiscord
             return true;
         }
 
-        static bool BuildWhisperEmbed(std::string const& eventType, std::string const& payload, dpp::embed& embed)
+        static bool BuildWhisperEmbed(std::string_view eventType, std::string_view payload, dpp::embed& embed)
         {
-            std::string block;
+            std::string_view block;
             if (!ExtractJsonBlock(payload, "whisper", block))
                 return false;
 
             std::string player;
             std::string gmName;
             std::string message;
+            std::string flags;
             uint32 ticketId = 0;
 
             ExtractJsonString(block, "player", player);
             ExtractJsonString(block, "gmName", gmName);
             ExtractJsonString(block, "message", message);
+            ExtractJsonString(block, "flags", flags);
             ExtractJsonUint(block, "ticketId", ticketId);
 
             if (player.empty())
@@ -684,13 +755,15 @@ namespace GMDiscord
             embed.add_field("Player", player, true);
             embed.add_field("GM", gmName, true);
             embed.add_field("Ticket", Acore::StringFormat("{}", ticketId), true);
+            if (!flags.empty())
+                embed.add_field("Flagged", flags, true);
             embed.set_color(eventType == "gm_whisper" ? 0x6FCF97 : 0x9B51E0);
             return true;
         }
 
-        static bool BuildCommandResultEmbed(std::string const& payload, dpp::embed& embed)
+        static bool BuildCommandResultEmbed(std::string_view payload, dpp::embed& embed)
         {
-            std::string block;
+            std::string_view block;
             if (!ExtractJsonBlock(payload, "command", block))
                 return false;
 
@@ -744,7 +817,7 @@ namespace GMDiscord
 
         static bool GetTicketRoomChannel(uint32 ticketId, uint64_t& channelId)
         {
-            QueryResult result = CharacterDatabase.Query(Acore::StringFormat(
+            QueryResult result = ModuleDB().Query(Acore::StringFormat(
                 "SELECT channel_id FROM gm_discord_ticket_room WHERE ticket_id={} LIMIT 1",
                 ticketId));
 
@@ -758,14 +831,14 @@ namespace GMDiscord
 
         static void UpsertTicketRoom(uint32 ticketId, uint64_t channelId, uint64_t guildId)
         {
-            CharacterDatabase.Execute(Acore::StringFormat(
+            ModuleDB().Execute(Acore::StringFormat(
                 "REPLACE INTO gm_discord_ticket_room (ticket_id, channel_id, guild_id, created_at) VALUES ({}, {}, {}, NOW())",
                 ticketId, channelId, guildId));
         }
 
         static void MarkTicketRoomArchived(uint32 ticketId)
         {
-            CharacterDatabase.Execute(Acore::StringFormat(
+            ModuleDB().Execute(Acore::StringFormat(
                 "UPDATE gm_discord_ticket_room SET archived_at=NOW() WHERE ticket_id={} LIMIT 1",
                 ticketId));
         }
@@ -774,14 +847,18 @@ namespace GMDiscord
         {
             std::string actionEsc = EscapeSql(action);
             std::string payloadEsc = EscapeSql(payload);
-            CharacterDatabase.Execute(Acore::StringFormat(
-                "INSERT INTO gm_discord_inbox (discord_user_id, action, payload) VALUES ({}, '{}', '{}')",
-                discordUserId, actionEsc, payloadEsc));
+            SpillQueue::Instance().Execute(Acore::StringFormat(
+                "INSERT INTO gm_discord_inbox (discord_user_id, action, lane, payload) VALUES ({}, '{}', {}, '{}')",
+                discordUserId, actionEsc, uint32(GetInboxLane(action)), payloadEsc));
+
+            static std::atomic<uint64>& queued = Metrics::Instance().Get("bot.inbox_actions");
+            queued.fetch_add(1, std::memory_order_relaxed);
+            SignalInboxActivity();
         }
 
         static bool GetGmNameForDiscordUser(uint64 discordUserId, std::string& gmName)
         {
-            QueryResult result = CharacterDatabase.Query(Acore::StringFormat(
+            QueryResult result = ModuleDB().Query(Acore::StringFormat(
                 "SELECT gm_name FROM gm_discord_link WHERE discord_user_id={} AND verified=1 LIMIT 1",
                 discordUserId));
 
@@ -794,9 +871,292 @@ namespace GMDiscord
             return !gmName.empty();
         }
 
+        // Counts a REST call as in flight until its completion callback runs,
+        // so shutdown can wait for outstanding requests before disconnecting.
+        static dpp::command_completion_event_t TrackRequest(std::atomic<uint32_t>& counter,
+            dpp::command_completion_event_t callback = {})
+        {
+            counter.fetch_add(1, std::memory_order_relaxed);
+            return [&counter, callback](const dpp::confirmation_callback_t& cb)
+            {
+                if (callback)
+                    callback(cb);
+                counter.fetch_sub(1, std::memory_order_release);
+            };
+        }
+
+        using TranscriptDone = std::function<void(std::vector<TranscriptLine>)>;
+
+        // Discord returns at most a page of messages per call, newest first;
+        // page back with `before` until a short page ends the thread. The
+        // panel and relayed player replies are the bot's own and already in
+        // the outbox rows, so only what people typed is kept. A failed page
+        // leaves a note at the top of the transcript instead of a silent gap.
+        static void FetchThreadMessages(dpp::cluster* clusterPtr, std::atomic<uint32_t>& inflight, uint64_t threadId,
+            uint64_t before, std::vector<TranscriptLine> lines, TranscriptDone done)
+        {
+            clusterPtr->messages_get(threadId, 0, before, 0, DISCORD_MESSAGE_PAGE, TrackRequest(inflight,
+                [clusterPtr, &inflight, threadId, lines = std::move(lines), done = std::move(done)](const dpp::confirmation_callback_t& cb) mutable
+                {
+                    if (cb.is_error())
+                    {
+                        TranscriptLine note;
+                        note.json = R"({"at":0,"source":"transcript","content":"Thread history is incomplete; Discord refused a page."})";
+                        lines.push_back(std::move(note));
+                        done(std::move(lines));
+                        return;
+                    }
+
+                    auto const& page = std::get<dpp::message_map>(cb.value);
+                    uint64_t oldest = 0;
+                    for (auto const& [messageId, message] : page)
+                    {
+                        uint64_t id = static_cast<uint64_t>(messageId);
+                        if (!oldest || id < oldest)
+                            oldest = id;
+                        if (message.author.is_bot())
+                            continue;
+
+                        TranscriptLine line;
+                        line.at = static_cast<uint64_t>(message.sent);
+                        line.json = Acore::StringFormat(
+                            R"({{"at":{},"source":"thread","author":"{}","authorId":{},"content":"{}"}})",
+                            line.at, EscapeJson(message.author.username), static_cast<uint64_t>(message.author.id),
+                            EscapeJson(message.content));
+                        lines.push_back(std::move(line));
+                    }
+
+                    if (page.size() < DISCORD_MESSAGE_PAGE || !oldest)
+                    {
+                        done(std::move(lines));
+                        return;
+                    }
+
+                    FetchThreadMessages(clusterPtr, inflight, threadId, oldest, std::move(lines), std::move(done));
+                }));
+        }
+
+        using SendQueue = ChannelSendQueue<dpp::message, dpp::command_completion_event_t>;
+
+        static SendQueue& GetSendQueue()
+        {
+            static SendQueue queue;
+            return queue;
+        }
+
+        static uint64_t GetSteadyMs()
+        {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        // Characters Discord counts against the per-message embed total.
+        static size_t GetEmbedLength(dpp::embed const& embed)
+        {
+            size_t length = embed.title.size() + embed.description.size();
+            for (dpp::embed_field const& field : embed.fields)
+                length += field.name.size() + field.value.size();
+            if (embed.footer)
+                length += embed.footer->text.size();
+            if (embed.author)
+                length += embed.author->name.size();
+            return length;
+        }
+
+        // Queued posts to the same channel fold into one message: plain text
+        // up to the message limit, embed-only posts up to Discord's embed
+        // count and total size. Posts with a callback (their id becomes an
+        // edit or thread target) are never folded.
+        static bool MergeMessages(dpp::message& into, dpp::message const& next)
+        {
+            if (!into.components.empty() || !next.components.empty() || !into.file_data.empty() || !next.file_data.empty())
+                return false;
+
+            if (into.embeds.empty() && next.embeds.empty())
+            {
+                if (into.content.size() + 1 + next.content.size() > DISCORD_MESSAGE_LIMIT)
+                    return false;
+
+                into.content += '\n';
+                into.content += next.content;
+                return true;
+            }
+
+            if (!into.content.empty() || !next.content.empty() || into.embeds.empty() || next.embeds.empty() ||
+                into.embeds.size() + next.embeds.size() > DISCORD_MAX_EMBEDS)
+                return false;
+
+            size_t length = 0;
+            for (dpp::embed const& embed : into.embeds)
+                length += GetEmbedLength(embed);
+            for (dpp::embed const& embed : next.embeds)
+                length += GetEmbedLength(embed);
+            if (length > DISCORD_EMBED_TOTAL_LIMIT)
+                return false;
+
+            into.embeds.insert(into.embeds.end(), next.embeds.begin(), next.embeds.end());
+            return true;
+        }
+
+        // Posts go through the destination channel's send queue; the bot's
+        // send timer (and each outbox dispatch) drains it.
+        static void QueueMessage(dpp::message message, dpp::command_completion_event_t callback = {})
+        {
+            static std::atomic<uint64>& dropped = Metrics::Instance().Get("send_queue.dropped");
+            uint64_t channelId = message.channel_id;
+            if (!GetSendQueue().Push(channelId, std::move(message), std::move(callback)))
+                dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Edits count against the same channel bucket as new posts.
+        static void QueueEdit(dpp::message message, dpp::command_completion_event_t callback = {})
+        {
+            static std::atomic<uint64>& dropped = Metrics::Instance().Get("send_queue.dropped");
+            uint64_t channelId = message.channel_id;
+            if (!GetSendQueue().Push(channelId, std::move(message), std::move(callback), true))
+                dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Zero ids are ignored.
+        static bool HasSendRoom(std::initializer_list<uint64_t> channelIds)
+        {
+            for (uint64_t channelId : channelIds)
+                if (channelId && !GetSendQueue().HasRoom(channelId))
+                    return false;
+            return true;
+        }
+
+        static bool ReplyIfShuttingDown(dpp::interaction_create_t const& event, bool accepting)
+        {
+            if (accepting)
+                return false;
+
+            event.reply(dpp::message("The server is shutting down. Please try again after it restarts.").set_flags(dpp::m_ephemeral));
+            return true;
+        }
+
+        static bool ReplyIfDatabaseDegraded(dpp::interaction_create_t const& event)
+        {
+            if (!SpillQueue::Instance().IsDegraded())
+                return false;
+
+            // Lookups would block the event loop on a sick DB.
+            event.reply(dpp::message("The game database is busy. Please try again shortly.").set_flags(dpp::m_ephemeral));
+            return true;
+        }
+
+        // FNV-1a over the serialized definitions; stable across builds so a
+        // restart can tell whether Discord already has this command set.
+        static uint64_t GetCommandSignature(std::vector<dpp::slashcommand> const& commands, uint64_t guildId)
+        {
+            uint64_t hash = 14695981039346656037ULL;
+            auto mix = [&hash](std::string const& text)
+            {
+                for (unsigned char c : text)
+                {
+                    hash ^= c;
+                    hash *= 1099511628211ULL;
+                }
+            };
+
+            mix(std::to_string(guildId));
+            for (dpp::slashcommand const& command : commands)
+                mix(command.build_json());
+            return hash ? hash : 1;
+        }
+
+        static uint64_t LoadCommandSignature()
+        {
+            if (SpillQueue::Instance().IsDegraded())
+                return 0;
+
+            QueryResult result = ModuleDB().Query("SELECT value FROM gm_discord_bot_state WHERE name='commands'");
+            if (!result)
+                return 0;
+
+            std::string value = (*result)[0].Get<std::string>();
+            uint64_t signature = 0;
+            std::from_chars(value.data(), value.data() + value.size(), signature);
+            return signature;
+        }
+
+        static void SaveCommandSignature(uint64_t signature)
+        {
+            SpillQueue::Instance().Execute(Acore::StringFormat(
+                "REPLACE INTO gm_discord_bot_state (name, value) VALUES ('commands', '{}')", signature));
+        }
+
+        // Feeds the ticket text and whispers carried by an outbox row to the
+        // search index. Ticket fields are re-sent on every update; the index
+        // drops the ones that did not change.
+        static void IndexOutboxEvent(std::string_view eventType, std::string_view payload, uint32 ticketId)
+        {
+            TicketIndex& index = TicketIndex::Instance();
+            if (!index.IsOpen())
+                return;
+
+            uint64_t now = static_cast<uint64_t>(std::time(nullptr));
+            std::string_view block;
+            std::string player;
+            std::string text;
+            if (eventType == "player_whisper" || eventType == "gm_whisper")
+            {
+                if (!ExtractJsonBlock(payload, "whisper", block))
+                    return;
+
+                ExtractJsonString(block, "player", player);
+                if (ExtractJsonString(block, "message", text))
+                    index.Add(ticketId, now, eventType == "gm_whisper" ? TICKET_TEXT_GM_WHISPER : TICKET_TEXT_PLAYER_WHISPER, player, text);
+                return;
+            }
+
+            if (!ExtractJsonBlock(payload, "ticket", block))
+                return;
+
+            static constexpr std::pair<std::string_view, TicketTextKind> fields[] =
+            {
+                { "message", TICKET_TEXT_MESSAGE },
+                { "comment", TICKET_TEXT_COMMENT },
+                { "response", TICKET_TEXT_RESPONSE },
+            };
+
+            ExtractJsonString(block, "player", player);
+            for (auto const& [key, kind] : fields)
+                if (ExtractJsonString(block, key, text))
+                    index.Add(ticketId, now, kind, player, text);
+        }
+
+        // Newest lines win when the field fills up.
+        static std::string FormatConversation(std::vector<ConversationLine> const& lines)
+        {
+            std::string out;
+            for (auto it = lines.rbegin(); it != lines.rend(); ++it)
+            {
+                std::string entry = Acore::StringFormat("<t:{}:t> **{}**{}: {}\n",
+                    it->at, it->author, it->fromPlayer ? "" : " (GM)", it->text);
+                if (out.size() + entry.size() > DISCORD_EMBED_FIELD_LIMIT)
+                    break;
+                out.insert(0, entry);
+            }
+            return out;
+        }
+
+        static char const* GetTicketTextKindName(TicketTextKind kind)
+        {
+            switch (kind)
+            {
+                case TICKET_TEXT_MESSAGE: return "ticket";
+                case TICKET_TEXT_COMMENT: return "comment";
+                case TICKET_TEXT_RESPONSE: return "response";
+                case TICKET_TEXT_PLAYER_WHISPER: return "player whisper";
+                case TICKET_TEXT_GM_WHISPER: return "GM whisper";
+            }
+            return "ticket";
+        }
+
         static bool MarkOutboxDispatched(uint32 id)
         {
-            CharacterDatabase.Execute(Acore::StringFormat(
+            ModuleDB().Execute(Acore::StringFormat(
                 "UPDATE gm_discord_outbox SET dispatched=1, dispatched_at=NOW() WHERE id={} LIMIT 1",
                 id));
             return true;
@@ -810,31 +1170,66 @@ namespace GMDiscord
 
     void DiscordBot::LoadConfig()
     {
-        _enabled = sConfigMgr->GetOption<bool>("GMDiscord.Bot.Enable", false);
-        _botId = sConfigMgr->GetOption<std::string>("GMDiscord.Bot.Id", "");
-        _botToken = sConfigMgr->GetOption<std::string>("GMDiscord.Bot.Token", "");
-        _guildId = sConfigMgr->GetOption<uint64_t>("GMDiscord.Bot.GuildId", 0);
-        _outboxChannelId = sConfigMgr->GetOption<uint64_t>("GMDiscord.Bot.OutboxChannelId", 0);
-        _ticketRoomsEnabled = sConfigMgr->GetOption<bool>("GMDiscord.Bot.TicketRooms.Enable", false);
-        _ticketRoomCategoryId = sConfigMgr->GetOption<uint64_t>("GMDiscord.Bot.TicketRooms.CategoryId", 0);
-        _ticketRoomArchiveCategoryId = sConfigMgr->GetOption<uint64_t>("GMDiscord.Bot.TicketRooms.ArchiveCategoryId", 0);
-        _ticketRoomNameFormat = sConfigMgr->GetOption<std::string>("GMDiscord.Bot.TicketRooms.NameFormat", "ticket-{id}-{player}");
-        _ticketRoomPostUpdates = sConfigMgr->GetOption<bool>("GMDiscord.Bot.TicketRooms.PostUpdates", true);
-        _ticketRoomArchiveOnClose = sConfigMgr->GetOption<bool>("GMDiscord.Bot.TicketRooms.ArchiveOnClose", true);
-        _ticketRoomAllowedRoleIds = ParseRoleList(sConfigMgr->GetOption<std::string>("GMDiscord.Bot.TicketRooms.AllowedRoles", ""));
-        _roleMappingsRaw = sConfigMgr->GetOption<std::string>("GMDiscord.Bot.RoleMappings", "");
-        _roleCategoryMap = ParseRoleMappings(_roleMappingsRaw);
+        auto settings = std::make_unique<Settings>();
+        settings->enabled = sConfigMgr->GetOption<bool>("GMDiscord.Bot.Enable", false);
+        settings->botId = sConfigMgr->GetOption<std::string>("GMDiscord.Bot.Id", "");
+        settings->botToken = sConfigMgr->GetOption<std::string>("GMDiscord.Bot.Token", "");
+        settings->guildId = sConfigMgr->GetOption<uint64_t>("GMDiscord.Bot.GuildId", 0);
+        settings->outboxChannelId = sConfigMgr->GetOption<uint64_t>("GMDiscord.Bot.OutboxChannelId", 0);
+        settings->ticketRoomsEnabled = sConfigMgr->GetOption<bool>("GMDiscord.Bot.TicketRooms.Enable", false);
+        settings->ticketRoomCategoryId = sConfigMgr->GetOption<uint64_t>("GMDiscord.Bot.TicketRooms.CategoryId", 0);
+        settings->ticketRoomArchiveCategoryId = sConfigMgr->GetOption<uint64_t>("GMDiscord.Bot.TicketRooms.ArchiveCategoryId", 0);
+        settings->ticketRoomNameFormat = sConfigMgr->GetOption<std::string>("GMDiscord.Bot.TicketRooms.NameFormat", "ticket-{id}-{player}");
+        settings->ticketRoomPostUpdates = sConfigMgr->GetOption<bool>("GMDiscord.Bot.TicketRooms.PostUpdates", true);
+        settings->ticketRoomArchiveOnClose = sConfigMgr->GetOption<bool>("GMDiscord.Bot.TicketRooms.ArchiveOnClose", true);
+        settings->roleCategoryMap = ParseRoleMappings(sConfigMgr->GetOption<std::string>("GMDiscord.Bot.RoleMappings", ""));
+        settings->shutdownDrainMs = sConfigMgr->GetOption<uint32_t>("GMDiscord.Shutdown.DrainTimeoutMs", 5000);
+        settings->escalationChannelId = sConfigMgr->GetOption<uint64_t>("GMDiscord.Bot.Escalation.ChannelId", 0);
+        settings->escalationRoleId = sConfigMgr->GetOption<uint64_t>("GMDiscord.Bot.Escalation.RoleId", 0);
+        settings->alertChannelId = sConfigMgr->GetOption<uint64_t>("GMDiscord.Bot.Alert.ChannelId", 0);
+        settings->transcriptEnabled = sConfigMgr->GetOption<bool>("GMDiscord.Bot.Transcript.Enable", false);
+        settings->transcriptDirectory = sConfigMgr->GetOption<std::string>("GMDiscord.Bot.Transcript.Directory", "gm_discord_transcripts");
+        settings->presenceEnabled = sConfigMgr->GetOption<bool>("GMDiscord.Bot.Presence.Enable", false);
+        settings->statusChannelId = sConfigMgr->GetOption<uint64_t>("GMDiscord.Bot.Status.ChannelId", 0);
+        settings->statusIntervalSeconds = sConfigMgr->GetOption<uint32_t>("GMDiscord.Status.IntervalSeconds", 60);
+        settings->logRelayChannelId = sConfigMgr->GetOption<uint64_t>("GMDiscord.Bot.LogRelay.ChannelId", 0);
+        settings->logRelayIntervalSeconds = std::max<uint32_t>(1, sConfigMgr->GetOption<uint32_t>("GMDiscord.Bot.LogRelay.IntervalSeconds", 5));
+        settings->searchEnabled = sConfigMgr->GetOption<bool>("GMDiscord.Bot.Search.Enable", false);
+        settings->searchIndexFile = sConfigMgr->GetOption<std::string>("GMDiscord.Bot.Search.IndexFile", "gm_discord_search.seg");
+        settings->digestIntervalMinutes = std::max<uint32_t>(1, sConfigMgr->GetOption<uint32_t>("GMDiscord.Bot.Digest.IntervalMinutes", 60));
+        settings->digestChannelId = sConfigMgr->GetOption<uint64_t>("GMDiscord.Bot.Digest.ChannelId", 0);
+        for (std::string const& eventType : Split(ToLower(sConfigMgr->GetOption<std::string>("GMDiscord.Bot.Digest.Events", "")), ','))
+        {
+            // Creation opens the thread and escalations must ping right away.
+            if (eventType == "ticket_update" || eventType == "ticket_status" || eventType == "ticket_close" || eventType == "ticket_resolve")
+                settings->digestEvents.insert(eventType);
+            else
+                LOG_ERROR("module.gm_discord", "GMDiscord.Bot.Digest.Events: {} cannot be digested.", eventType);
+        }
+
+        std::unordered_set<uint64_t> roomRoles = ParseRoleList(sConfigMgr->GetOption<std::string>("GMDiscord.Bot.TicketRooms.AllowedRoles", ""));
+        if (roomRoles.empty())
+        {
+            for (uint64_t roleId : settings->roleCategoryMap.roleMasks.Keys())
+                roomRoles.insert(roleId);
+        }
+        settings->ticketRoomRoleIds.assign(roomRoles.begin(), roomRoles.end());
+
+        LogRelay::Instance().SetEnabled(settings->enabled && settings->logRelayChannelId);
+        TicketLinkCache::Instance().LoadConfig();
+        _settings.Publish(std::move(settings));
     }
 
     void DiscordBot::Start()
     {
-        if (!_enabled)
+        Settings const& startSettings = _settings.Get();
+        if (!startSettings.enabled)
         {
             LOG_INFO("module.gm_discord", "Discord bot is disabled.");
             return;
         }
 
-        if (_botId.empty() || _botToken.empty())
+        if (startSettings.botId.empty() || startSettings.botToken.empty())
         {
             LOG_ERROR("module.gm_discord", "Discord bot cannot start: missing bot id or token.");
             return;
@@ -846,10 +1241,11 @@ namespace GMDiscord
         if (_running.exchange(true))
             return;
 
+        _accepting = true;
         uint64_t appId = 0;
         try
         {
-            appId = std::stoull(_botId);
+            appId = std::stoull(startSettings.botId);
         }
         catch (...)
         {
@@ -858,8 +1254,16 @@ namespace GMDiscord
             return;
         }
 
-        auto* cluster = new dpp::cluster(_botToken);
+        if (startSettings.searchEnabled)
+            TicketIndex::Instance().Open(startSettings.searchIndexFile);
+
+        LoadDigest();
+
+        auto* cluster = new dpp::cluster(startSettings.botToken);
         cluster->intents = dpp::i_default_intents | dpp::i_message_content;
+        // Members are cached so presence updates can check ticket roles.
+        if (startSettings.presenceEnabled)
+            cluster->intents |= dpp::i_guild_presences | dpp::i_guild_members;
         _cluster = cluster;
         cluster->on_log([=](const dpp::log_t& event)
         {
@@ -868,21 +1272,30 @@ namespace GMDiscord
 
         cluster->on_button_click([=](const dpp::button_click_t& event)
         {
-            if (_guildId && event.command.guild_id != _guildId)
+            Settings const& settings = _settings.Get();
+            if (ReplyIfShuttingDown(event, _accepting))
+                return;
+
+            if (settings.guildId && event.command.guild_id != settings.guildId)
             {
                 event.reply(dpp::message("This bot is not enabled in this guild.").set_flags(dpp::m_ephemeral));
                 return;
             }
 
+            NoteGmActivity(settings.roleCategoryMap, event.command);
+
             uint32 ticketId = 0;
             if (TryParsePanelTicketId(event.custom_id, "gm_ticket_claim:", ticketId))
             {
-                if (!HasRoleForCategory(_roleCategoryMap, event.command.member.get_roles(), "ticket"))
+                if (!HasRoleForCategory(settings.roleCategoryMap, event.command.member.get_roles(), "ticket"))
                 {
                     event.reply(dpp::message("You are not allowed to claim tickets.").set_flags(dpp::m_ephemeral));
                     return;
                 }
 
+                if (ReplyIfDatabaseDegraded(event))
+                    return;
+
                 std::string gmName;
                 if (!GetGmNameForDiscordUser(event.command.usr.id, gmName))
                 {
@@ -897,7 +1310,7 @@ namespace GMDiscord
 
             if (TryParsePanelTicketId(event.custom_id, "gm_ticket_close:", ticketId))
             {
-                if (!HasRoleForCategory(_roleCategoryMap, event.command.member.get_roles(), "ticket"))
+                if (!HasRoleForCategory(settings.roleCategoryMap, event.command.member.get_roles(), "ticket"))
                 {
                     event.reply(dpp::message("You are not allowed to close tickets.").set_flags(dpp::m_ephemeral));
                     return;
@@ -921,7 +1334,7 @@ namespace GMDiscord
 
             if (TryParsePanelTicketId(event.custom_id, "gm_ticket_details:", ticketId))
             {
-                if (!HasRoleForCategory(_roleCategoryMap, event.command.member.get_roles(), "ticket"))
+                if (!HasRoleForCategory(settings.roleCategoryMap, event.command.member.get_roles(), "ticket"))
                 {
                     event.reply(dpp::message("You are not allowed to view ticket details.").set_flags(dpp::m_ephemeral));
                     return;
@@ -954,19 +1367,87 @@ namespace GMDiscord
                     return;
                 }
 
+                std::string conversation = FormatConversation(ConversationBuffer::Instance().GetLines(ticketId));
+                if (!conversation.empty())
+                    embed.add_field("Recent conversation", conversation, false);
+
                 event.reply(dpp::message().add_embed(embed).set_flags(dpp::m_ephemeral));
                 return;
             }
         });
 
+        // Ticket id suggestions: open tickets matching the typed id or player
+        // name, previewing the latest whisper.
+        cluster->on_autocomplete([=](const dpp::autocomplete_t& event)
+        {
+            Settings const& settings = _settings.Get();
+            dpp::interaction_response response(dpp::ir_autocomplete_reply);
+            if (_accepting && (!settings.guildId || event.command.guild_id == settings.guildId)
+                && HasRoleForCategory(settings.roleCategoryMap, event.command.member.get_roles(), "ticket"))
+            {
+                std::string typed;
+                for (auto const& option : event.options)
+                {
+                    if (!option.focused)
+                        continue;
+                    if (std::holds_alternative<std::string>(option.value))
+                        typed = std::get<std::string>(option.value);
+                    else if (std::holds_alternative<int64_t>(option.value))
+                        typed = std::to_string(std::get<int64_t>(option.value));
+                }
+
+                for (OpenTicketPreview const& preview : ConversationBuffer::Instance().Find(Trim(typed), DISCORD_MAX_CHOICES))
+                {
+                    std::string label = Acore::StringFormat("#{} {}", preview.ticketId, preview.player);
+                    if (!preview.lastLine.empty())
+                        label += ": " + preview.lastLine;
+                    if (label.size() > DISCORD_CHOICE_NAME_LIMIT)
+                    {
+                        // Don't split a UTF-8 sequence.
+                        size_t cut = DISCORD_CHOICE_NAME_LIMIT - 3;
+                        while (cut && (static_cast<unsigned char>(label[cut]) & 0xC0) == 0x80)
+                            --cut;
+                        label = label.substr(0, cut) + "...";
+                    }
+                    response.add_autocomplete_choice(dpp::command_option_choice(label, static_cast<int64_t>(preview.ticketId)));
+                }
+            }
+
+            cluster->interaction_response_create(event.command.id, event.command.token, response);
+        });
+
+        cluster->on_presence_update([=](const dpp::presence_update_t& event)
+        {
+            // Presence updates carry no roles; the member cache does. An
+            // uncached member keeps what the last update or interaction saw.
+            if (dpp::guild* guild = dpp::find_guild(event.rich_presence.guild_id))
+            {
+                auto member = guild->members.find(event.rich_presence.user_id);
+                if (member != guild->members.end())
+                    GmPresence::Instance().SetTicketRole(event.rich_presence.user_id,
+                        HasRoleForCategory(_settings.Get().roleCategoryMap, member->second.get_roles(), "ticket"));
+            }
+
+            uint32 accountId = GmPresence::Instance().SetDiscordStatus(event.rich_presence.user_id,
+                event.rich_presence.status() != dpp::ps_offline);
+            if (accountId)
+                AutoAssigner::Instance().OnPresenceChanged(accountId);
+        });
+
         cluster->on_form_submit([=](const dpp::form_submit_t& event)
         {
-            if (_guildId && event.command.guild_id != _guildId)
+            Settings const& settings = _settings.Get();
+            if (ReplyIfShuttingDown(event, _accepting))
+                return;
+
+            if (settings.guildId && event.command.guild_id != settings.guildId)
             {
                 event.reply(dpp::message("This bot is not enabled in this guild.").set_flags(dpp::m_ephemeral));
                 return;
             }
 
+            NoteGmActivity(settings.roleCategoryMap, event.command);
+
             uint32 ticketId = 0;
             if (TryParsePanelTicketId(event.custom_id, "gm_ticket_close:", ticketId))
             {
@@ -977,6 +1458,9 @@ namespace GMDiscord
                     return;
                 }
 
+                if (ReplyIfDatabaseDegraded(event))
+                    return;
+
                 std::string gmName;
                 if (!GetGmNameForDiscordUser(event.command.usr.id, gmName))
                 {
@@ -994,365 +1478,109 @@ namespace GMDiscord
 
         cluster->on_ready([=](const dpp::ready_t& event)
         {
-            if (dpp::run_once<struct gm_discord_ready>())
-            {
-                dpp::slashcommand auth("gm-auth", "Link your GM account", appId);
-                auth.add_option(dpp::command_option(dpp::co_string, "secret", "Secret from in-game .discord link", true));
-
-                dpp::slashcommand command("gm-command", "Execute GM command", appId);
-                command.add_option(dpp::command_option(dpp::co_string, "command", "GM command, e.g. .ticket list", true));
-
-                dpp::slashcommand whisper("gm-whisper", "Whisper a player as your GM name", appId);
-                whisper.add_option(dpp::command_option(dpp::co_string, "player", "Player name", true));
-                whisper.add_option(dpp::command_option(dpp::co_string, "message", "Message to send", true));
-
-                dpp::slashcommand assign("gm-ticket-assign", "Assign a ticket to a GM", appId);
-                assign.add_option(dpp::command_option(dpp::co_integer, "ticket_id", "Ticket ID", true));
-                assign.add_option(dpp::command_option(dpp::co_string, "gm_name", "GM character name", true));
-
-                if (_guildId)
-                    cluster->guild_command_create(auth, _guildId);
-                else
-                    cluster->global_command_create(auth);
-
-                if (_guildId)
-                    cluster->guild_command_create(command, _guildId);
-                else
-                    cluster->global_command_create(command);
+            Settings const& settings = _settings.Get();
+            static std::atomic<uint64>& identifies = Metrics::Instance().Get("gateway.identifies");
+            // A ready after the first means Discord refused a resume; keep
+            // its work idempotent so a fresh session changes nothing here.
+            if (identifies.fetch_add(1, std::memory_order_relaxed))
+                LOG_WARN("module.gm_discord", "Discord gateway started a new session (shard {}).", event.shard_id);
+            else
+                LOG_INFO("module.gm_discord", "Discord bot ready.");
 
-                if (_guildId)
-                    cluster->guild_command_create(whisper, _guildId);
-                else
-                    cluster->global_command_create(whisper);
+            RegisterCommands(appId);
 
-                if (_guildId)
-                    cluster->guild_command_create(assign, _guildId);
-                else
-                    cluster->global_command_create(assign);
+            if (settings.outboxChannelId && !_outboxTimer)
+            {
+                _outboxTimer = cluster->start_timer([this](dpp::timer /*timer*/)
+                {
+                    DispatchOutbox(10);
+                }, 5);
+            }
 
-                LOG_INFO("module.gm_discord", "Discord bot ready.");
+            if (!settings.digestEvents.empty() && !_digestTimer)
+            {
+                _digestTimer = cluster->start_timer([this](dpp::timer /*timer*/)
+                {
+                    PostDigest();
+                }, settings.digestIntervalMinutes * 60);
             }
 
-            if (_outboxChannelId)
+            if (!_sendQueueTimer)
             {
-                cluster->start_timer([this](dpp::timer timer)
+                _sendQueueTimer = cluster->start_timer([this](dpp::timer /*timer*/)
                 {
-                    auto* clusterPtr = static_cast<dpp::cluster*>(_cluster);
-                    if (!clusterPtr)
-                        return;
+                    PumpSendQueue();
+                }, 1);
+            }
 
-                    QueryResult result = CharacterDatabase.Query(
-                        "SELECT id, event_type, payload FROM gm_discord_outbox WHERE dispatched=0 ORDER BY id ASC LIMIT 10");
-                    if (!result)
-                        return;
+            if (settings.statusChannelId && settings.statusIntervalSeconds && !_statusTimer)
+            {
+                _statusTimer = cluster->start_timer([this](dpp::timer /*timer*/)
+                {
+                    PublishStatus();
+                }, settings.statusIntervalSeconds);
+            }
 
-                    do
-                    {
-                        Field* fields = result->Fetch();
-                        uint32 id = fields[0].Get<uint32>();
-                        std::string eventType = fields[1].Get<std::string>();
-                        std::string payload = fields[2].Get<std::string>();
-
-                        uint32 ticketId = 0;
-                        bool hasTicketId = false;
-                        if (eventType.rfind("ticket_", 0) == 0)
-                        {
-                            std::string ticketBlock;
-                            if (ExtractJsonBlock(payload, "ticket", ticketBlock))
-                                hasTicketId = ExtractJsonUint(ticketBlock, "id", ticketId);
-                        }
-                        else if (eventType == "player_whisper" || eventType == "gm_whisper")
-                        {
-                            std::string whisperBlock;
-                            if (ExtractJsonBlock(payload, "whisper", whisperBlock))
-                                hasTicketId = ExtractJsonUint(whisperBlock, "ticketId", ticketId);
-                        }
+            if (settings.logRelayChannelId && !_logRelayTimer)
+            {
+                _logRelayTimer = cluster->start_timer([this](dpp::timer /*timer*/)
+                {
+                    uint64_t channelId = _settings.Get().logRelayChannelId;
+                    std::string batch = LogRelay::Instance().TakeBatch(DISCORD_MESSAGE_LIMIT);
+                    if (channelId && !batch.empty())
+                        QueueMessage(dpp::message(channelId, batch));
+                }, settings.logRelayIntervalSeconds);
+            }
+        });
 
-                        dpp::embed embed;
-                        bool hasEmbed = false;
-						if (eventType == "command_result")
-						{
-							MarkOutboxDispatched(id);
-							continue;
-						}
-						else if (eventType == "player_whisper" || eventType == "gm_whisper")
-                            hasEmbed = BuildWhisperEmbed(eventType, payload, embed);
-                        else if (eventType.rfind("ticket_", 0) == 0)
-                            hasEmbed = BuildTicketEmbed(eventType, payload, embed);
-
-						if (_outboxChannelId)
-						{
-							if (eventType == "player_whisper")
-							{
-								if (hasTicketId)
-								{
-									auto threadIt = _ticketThreadIds.find(ticketId);
-									if (threadIt != _ticketThreadIds.end())
-									{
-										if (hasEmbed)
-											clusterPtr->message_create(dpp::message(threadIt->second, "").add_embed(embed));
-										else
-											clusterPtr->message_create(dpp::message(threadIt->second, TruncateForDiscord(Acore::StringFormat("[{}] {}", eventType, payload))));
-									}
-								}
-								MarkOutboxDispatched(id);
-								continue;
-							}
-
-							bool createThread = (eventType == "ticket_create" && hasTicketId);
-							bool isTicketUpdate = (eventType.rfind("ticket_", 0) == 0 && eventType != "ticket_create" && hasTicketId);
-							bool editedMessage = false;
-
-							if (isTicketUpdate)
-							{
-								auto messageIt = _ticketMessageIds.find(ticketId);
-								if (messageIt != _ticketMessageIds.end())
-								{
-									dpp::message editMessage(_outboxChannelId, "");
-									editMessage.id = messageIt->second;
-									if (hasEmbed)
-										editMessage.add_embed(embed);
-									else
-										editMessage.set_content(TruncateForDiscord(Acore::StringFormat("[{}] {}", eventType, payload)));
-
-									clusterPtr->message_edit(editMessage);
-									editedMessage = true;
-								}
-							}
-
-							if (editedMessage)
-							{
-							}
-							else if (createThread)
-                            {
-                                std::string playerName;
-                                if (!ExtractJsonString(payload, "player", playerName))
-                                    playerName = "player";
+        cluster->on_resumed([=](const dpp::resumed_t& /*event*/)
+        {
+            static std::atomic<uint64>& resumes = Metrics::Instance().Get("gateway.resumes");
+            resumes.fetch_add(1, std::memory_order_relaxed);
+            LOG_INFO("module.gm_discord", "Discord gateway session resumed.");
+        });
 
-                                std::string threadName = FormatTicketRoomName("ticket-{id}-{player}", playerName, ticketId);
-                                dpp::message outMessage = hasEmbed
-                                    ? dpp::message(_outboxChannelId, "").add_embed(embed)
-                                    : dpp::message(_outboxChannelId, TruncateForDiscord(Acore::StringFormat("[{}] {}", eventType, payload)));
+        cluster->on_message_create([=](const dpp::message_create_t& event)
+        {
+            Settings const& settings = _settings.Get();
+            if (!settings.outboxChannelId)
+                return;
 
-								clusterPtr->message_create(outMessage, [this, clusterPtr, threadName, ticketId](const dpp::confirmation_callback_t& cb)
-                                {
-                                    if (cb.is_error())
-                                        return;
+            if (event.msg.author.is_bot() || !_accepting)
+                return;
 
-                                    auto created = std::get<dpp::message>(cb.value);
-									_ticketMessageIds[ticketId] = static_cast<uint64_t>(created.id);
-                                    clusterPtr->thread_create_with_message(threadName, created.channel_id, created.id, 1440, 0,
-                                        [this, clusterPtr, ticketId](const dpp::confirmation_callback_t& threadCb)
-                                        {
-                                            if (threadCb.is_error())
-                                                return;
-
-                                        auto createdThread = std::get<dpp::thread>(threadCb.value);
-                                        uint64_t threadId = static_cast<uint64_t>(createdThread.id);
-                                        _ticketThreadIds[ticketId] = threadId;
-                                        _threadTicketIds[threadId] = ticketId;
-
-                                        dpp::message panelMessage(threadId, "GM Controls");
-                                        for (dpp::component const& row : BuildTicketPanelComponents(ticketId))
-                                            panelMessage.add_component(row);
-                                        clusterPtr->message_create(panelMessage);
-                                        });
-                                });
-                            }
-							else if (hasEmbed)
-							{
-								if (hasTicketId && eventType.rfind("ticket_", 0) == 0)
-								{
-									clusterPtr->message_create(dpp::message(_outboxChannelId, "").add_embed(embed),
-										[this, ticketId](const dpp::confirmation_callback_t& cb)
-										{
-											if (!cb.is_error())
-											{
-												auto created = std::get<dpp::message>(cb.value);
-												_ticketMessageIds[ticketId] = static_cast<uint64_t>(created.id);
-											}
-										});
-								}
-								else
-								{
-									clusterPtr->message_create(dpp::message(_outboxChannelId, "").add_embed(embed));
-								}
-							}
-							else
-							{
-								std::string content = TruncateForDiscord(Acore::StringFormat("[{}] {}", eventType, payload));
-								if (hasTicketId && eventType.rfind("ticket_", 0) == 0)
-								{
-									clusterPtr->message_create(dpp::message(_outboxChannelId, content),
-										[this, ticketId](const dpp::confirmation_callback_t& cb)
-										{
-											if (!cb.is_error())
-											{
-												auto created = std::get<dpp::message>(cb.value);
-												_ticketMessageIds[ticketId] = static_cast<uint64_t>(created.id);
-											}
-										});
-								}
-								else
-								{
-									clusterPtr->message_create(dpp::message(_outboxChannelId, content));
-								}
-							}
-                        }
+            auto* clusterPtr = static_cast<dpp::cluster*>(_cluster);
+            if (!clusterPtr)
+                return;
 
-                        if (_ticketRoomsEnabled && hasTicketId && _ticketRoomCategoryId && _guildId)
-                        {
-                            uint64_t channelId = 0;
-                            GetTicketRoomChannel(ticketId, channelId);
+            uint64 threadId = static_cast<uint64_t>(event.msg.channel_id);
+            uint64 discordUserId = event.msg.author.id;
 
-                            if (channelId == 0 && eventType == "ticket_create")
-                            {
-                                std::string playerName;
-                                if (!ExtractJsonString(payload, "player", playerName))
-                                    playerName = "player";
-                                std::string channelName = FormatTicketRoomName(_ticketRoomNameFormat, playerName, ticketId);
+            std::string content = Trim(event.msg.content);
+            if (content.empty())
+                return;
 
-                                dpp::channel channel;
-                                channel.set_name(channelName);
-                                channel.set_type(dpp::CHANNEL_TEXT);
-                                channel.set_parent_id(_ticketRoomCategoryId);
-
-                                std::vector<dpp::permission_overwrite> overwrites;
-
-                                std::unordered_set<uint64_t> allowedRoles = _ticketRoomAllowedRoleIds;
-                                if (allowedRoles.empty())
-                                {
-                                    for (std::unordered_map<uint64_t, std::unordered_set<std::string>>::const_iterator it = _roleCategoryMap.begin();
-                                        it != _roleCategoryMap.end(); ++it)
-                                        allowedRoles.insert(it->first);
-                                }
-
-                                bool allowEveryone = allowedRoles.empty();
-                                if (!allowEveryone)
-                                {
-                                    dpp::permission_overwrite everyone;
-                                    everyone.id = _guildId;
-                                    everyone.type = dpp::ot_role;
-                                    everyone.allow = 0;
-                                    everyone.deny = dpp::p_view_channel;
-                                    overwrites.push_back(everyone);
-                                }
-                                else
-                                {
-                                    allowedRoles.insert(_guildId);
-                                }
-
-                                for (uint64_t roleId : allowedRoles)
-                                {
-                                    dpp::permission_overwrite roleOverwrite;
-                                    roleOverwrite.id = roleId;
-                                    roleOverwrite.type = dpp::ot_role;
-                                    roleOverwrite.allow = dpp::p_view_channel | dpp::p_send_messages | dpp::p_read_message_history;
-                                    roleOverwrite.deny = 0;
-                                    overwrites.push_back(roleOverwrite);
-                                }
-
-                                channel.permission_overwrites = overwrites;
-
-                                clusterPtr->channel_create(channel, [=](const dpp::confirmation_callback_t& cb)
-                                {
-                                    if (!cb.is_error())
-                                    {
-                                        auto created = std::get<dpp::channel>(cb.value);
-                                        UpsertTicketRoom(ticketId, static_cast<uint64_t>(created.id), _guildId);
-                                    }
-                                });
-
-                            }
-
-                            if (channelId != 0 && _ticketRoomPostUpdates)
-                            {
-                                if (hasEmbed)
-                                    clusterPtr->message_create(dpp::message(channelId, "").add_embed(embed));
-                                else
-                                    clusterPtr->message_create(dpp::message(channelId, TruncateForDiscord(Acore::StringFormat("[{}] {}", eventType, payload))));
-                            }
-
-                            if (eventType == "ticket_close" || eventType == "ticket_resolve")
-                            {
-                                auto threadIt = _ticketThreadIds.find(ticketId);
-                                if (threadIt != _ticketThreadIds.end())
-                                {
-                                    uint64_t threadId = threadIt->second;
-                                    clusterPtr->thread_get(threadId, [this, clusterPtr, threadId](const dpp::confirmation_callback_t& cb)
-                                    {
-                                        if (cb.is_error())
-                                        {
-                                            _threadTicketIds.erase(threadId);
-                                            return;
-                                        }
-
-                                        auto threadInfo = std::get<dpp::thread>(cb.value);
-                                        threadInfo.metadata.auto_archive_duration = 1440;
-                                        threadInfo.metadata.archived = true;
-                                        threadInfo.metadata.locked = true;
-                                        clusterPtr->thread_edit(threadInfo);
-                                    });
-                                    _threadTicketIds.erase(threadIt->second);
-                                    _ticketThreadIds.erase(threadIt);
-                                }
-
-                                if (!_ticketRoomArchiveOnClose)
-                                    continue;
-
-                                dpp::channel ch;
-                                ch.id = channelId;
-                                if (_ticketRoomArchiveCategoryId)
-                                    ch.set_parent_id(_ticketRoomArchiveCategoryId);
-
-                                if (!hasEmbed)
-                                {
-                                    clusterPtr->message_create(dpp::message(channelId, "Ticket closed."));
-                                }
-
-                                clusterPtr->channel_edit(ch);
-                                MarkTicketRoomArchived(ticketId);
-                            }
-                        }
-
-                        MarkOutboxDispatched(id);
-                    } while (result->NextRow());
-                }, 5);
-            }
-        });
-
-        cluster->on_message_create([=](const dpp::message_create_t& event)
-        {
-            if (!_outboxChannelId)
-                return;
-
-            if (event.msg.author.is_bot())
-                return;
-
-            auto* clusterPtr = static_cast<dpp::cluster*>(_cluster);
-            if (!clusterPtr)
-                return;
-
-            uint64 threadId = static_cast<uint64_t>(event.msg.channel_id);
-            uint64 discordUserId = event.msg.author.id;
-
-            std::string content = Trim(event.msg.content);
-            if (content.empty())
-                return;
+            if (SpillQueue::Instance().IsDegraded())
+            {
+                uint32 ticketId = 0;
+                if (TicketLinkCache::Instance().PeekTicketByThread(threadId, ticketId))
+                    QueueMessage(dpp::message(threadId, "The game database is busy. Please resend shortly."));
+                return;
+            }
 
             auto processTicket = [this, clusterPtr, threadId, discordUserId, content](uint32 ticketId)
             {
                 GmTicket* ticket = sTicketMgr->GetTicket(ticketId);
                 if (!ticket || ticket->IsClosed())
                 {
-                    clusterPtr->message_create(dpp::message(threadId, "Ticket is closed or unavailable."));
+                    QueueMessage(dpp::message(threadId, "Ticket is closed or unavailable."));
                     return;
                 }
 
                 std::string gmName;
                 if (!GetGmNameForDiscordUser(discordUserId, gmName))
                 {
-                    clusterPtr->message_create(dpp::message(threadId, "You are not linked. Use in-game .discord link <secret>."));
+                    QueueMessage(dpp::message(threadId, "You are not linked. Use in-game .discord link <secret>."));
                     return;
                 }
 
@@ -1360,10 +1588,10 @@ namespace GMDiscord
                 InsertInboxAction(discordUserId, "whisper", payload);
             };
 
-            auto threadIt = _threadTicketIds.find(threadId);
-            if (threadIt != _threadTicketIds.end())
+            uint32 knownTicketId = 0;
+            if (TicketLinkCache::Instance().GetTicketByThread(threadId, knownTicketId))
             {
-                processTicket(threadIt->second);
+                processTicket(knownTicketId);
                 return;
             }
 
@@ -1377,20 +1605,25 @@ namespace GMDiscord
                 if (!TryParseTicketIdFromThreadName(threadInfo.name, ticketId))
                     return;
 
-                _threadTicketIds[threadId] = ticketId;
-                _ticketThreadIds[ticketId] = threadId;
+                TicketLinkCache::Instance().SetThread(ticketId, threadId);
                 processTicket(ticketId);
             });
         });
 
         cluster->on_slashcommand([=](const dpp::slashcommand_t& event)
         {
-            if (_guildId && event.command.guild_id != _guildId)
+            Settings const& settings = _settings.Get();
+            if (ReplyIfShuttingDown(event, _accepting))
+                return;
+
+            if (settings.guildId && event.command.guild_id != settings.guildId)
             {
                 event.reply(dpp::message("This bot is not enabled in this guild.").set_flags(dpp::m_ephemeral));
                 return;
             }
 
+            NoteGmActivity(settings.roleCategoryMap, event.command);
+
             uint64 discordUserId = event.command.usr.id;
             std::string name = event.command.get_command_name();
             std::vector<dpp::snowflake> roles = event.command.member.get_roles();
@@ -1407,7 +1640,7 @@ namespace GMDiscord
             {
                 std::string cmd = std::get<std::string>(event.get_parameter("command"));
                 std::string category = GetCommandCategory(GetCommandRoot(cmd));
-                if (!HasRoleForCategory(_roleCategoryMap, roles, category))
+                if (!HasRoleForCategory(settings.roleCategoryMap, roles, category))
                 {
                     event.reply(dpp::message("You are not allowed to run this command category.").set_flags(dpp::m_ephemeral));
                     return;
@@ -1423,12 +1656,15 @@ namespace GMDiscord
                 std::string player = std::get<std::string>(event.get_parameter("player"));
                 std::string message = std::get<std::string>(event.get_parameter("message"));
 
-                if (!HasRoleForCategory(_roleCategoryMap, roles, "whisper"))
+                if (!HasRoleForCategory(settings.roleCategoryMap, roles, "whisper"))
                 {
                     event.reply(dpp::message("You are not allowed to send whispers.").set_flags(dpp::m_ephemeral));
                     return;
                 }
 
+                if (ReplyIfDatabaseDegraded(event))
+                    return;
+
                 std::string gmName;
                 if (!GetGmNameForDiscordUser(discordUserId, gmName))
                 {
@@ -1444,7 +1680,7 @@ namespace GMDiscord
 
             if (name == "gm-ticket-assign")
             {
-                if (!HasRoleForCategory(_roleCategoryMap, roles, "ticket"))
+                if (!HasRoleForCategory(settings.roleCategoryMap, roles, "ticket"))
                 {
                     event.reply(dpp::message("You are not allowed to assign tickets.").set_flags(dpp::m_ephemeral));
                     return;
@@ -1464,9 +1700,95 @@ namespace GMDiscord
                 event.reply(dpp::message("Ticket assignment queued.").set_flags(dpp::m_ephemeral));
                 return;
             }
+
+            if (name == "gm-stats")
+            {
+                if (!HasRoleForCategory(settings.roleCategoryMap, roles, "server"))
+                {
+                    event.reply(dpp::message("You are not allowed to view module metrics.").set_flags(dpp::m_ephemeral));
+                    return;
+                }
+
+                dpp::command_interaction interaction = event.command.get_command_interaction();
+                bool tickets = !interaction.options.empty() && interaction.options[0].name == "tickets";
+
+                std::string body;
+                if (tickets)
+                    body = TicketStats::Instance().Render();
+                else
+                {
+                    for (auto const& [metric, value] : Metrics::Instance().Snapshot())
+                        body += Acore::StringFormat("{} = {}\n", metric, value);
+                    for (auto const& [channelId, depth] : GetSendQueue().GetDepths())
+                        body += Acore::StringFormat("send_queue.channel.{} = {}\n", channelId, depth);
+                    if (body.empty())
+                        body = "No metrics recorded yet.\n";
+                }
+
+                event.reply(dpp::message(Acore::StringFormat("```\n{}```", TruncateForDiscord(body))).set_flags(dpp::m_ephemeral));
+                return;
+            }
+
+            if (name == "gm-online")
+            {
+                if (!HasRoleForCategory(settings.roleCategoryMap, roles, "ticket"))
+                {
+                    event.reply(dpp::message("You are not allowed to view GM presence.").set_flags(dpp::m_ephemeral));
+                    return;
+                }
+
+                std::string body;
+                for (GmPresenceInfo const& gm : GmPresence::Instance().GetAll())
+                {
+                    char const* where = gm.inGame ? (gm.onDiscord ? "in game, Discord" : "in game") : (gm.onDiscord ? "Discord" : "offline");
+                    body += Acore::StringFormat("**{}** <@{}>: {}\n", gm.gmName.empty() ? "?" : gm.gmName, gm.discordUserId, where);
+                }
+                if (body.empty())
+                    body = "No linked GMs.";
+
+                dpp::message reply(TruncateForDiscord(body));
+                reply.set_allowed_mentions(false, false, false, false, {}, {});
+                event.reply(reply.set_flags(dpp::m_ephemeral));
+                return;
+            }
+
+            if (name == "gm-ticket-search")
+            {
+                if (!HasRoleForCategory(settings.roleCategoryMap, roles, "ticket"))
+                {
+                    event.reply(dpp::message("You are not allowed to search tickets.").set_flags(dpp::m_ephemeral));
+                    return;
+                }
+
+                if (!settings.searchEnabled || !TicketIndex::Instance().IsOpen())
+                {
+                    event.reply(dpp::message("Ticket search is disabled.").set_flags(dpp::m_ephemeral));
+                    return;
+                }
+
+                std::string query = std::get<std::string>(event.get_parameter("query"));
+                std::vector<TicketSearchHit> hits = TicketIndex::Instance().Search(query, 10);
+                if (hits.empty())
+                {
+                    event.reply(dpp::message("No matching tickets.").set_flags(dpp::m_ephemeral));
+                    return;
+                }
+
+                std::string body;
+                for (TicketSearchHit const& hit : hits)
+                {
+                    std::string snippet = hit.snippet;
+                    std::replace(snippet.begin(), snippet.end(), '\n', ' ');
+                    body += Acore::StringFormat("**#{}** {} ({}, <t:{}:R>)\n> {}\n",
+                        hit.ticketId, hit.player, GetTicketTextKindName(hit.kind), hit.at, snippet);
+                }
+
+                event.reply(dpp::message(TruncateForDiscord(body)).set_flags(dpp::m_ephemeral));
+                return;
+            }
         });
 
-        LOG_INFO("module.gm_discord", "Discord bot starting (id: {}).", _botId);
+        LOG_INFO("module.gm_discord", "Discord bot starting (id: {}).", startSettings.botId);
         _thread = std::thread([this]()
         {
             auto* clusterPtr = static_cast<dpp::cluster*>(_cluster);
@@ -1476,9 +1798,821 @@ namespace GMDiscord
 #endif
     }
 
+    uint32 DiscordBot::DispatchOutbox(uint32 limit)
+    {
+#if !GM_DISCORD_HAVE_DPP
+        (void)limit;
+        return 0;
+#else
+        std::lock_guard<std::mutex> guard(_dispatchMutex);
+        Settings const& settings = _settings.Get();
+        auto* clusterPtr = static_cast<dpp::cluster*>(_cluster);
+        if (!clusterPtr)
+            return 0;
+
+        if (SpillQueue::Instance().IsDegraded())
+            return 0;
+
+        // The dispatched=1 UPDATEs are async and can lag behind the next
+        // poll, so rows already handled this run are skipped by id. The
+        // limit grows by those so they cannot crowd out new rows.
+        uint64 fetchLimit = uint64(limit) + _outboxHandled.size();
+        QueryResult result = ModuleDB().Query(Acore::StringFormat(
+            "SELECT id, event_type, payload FROM gm_discord_outbox WHERE dispatched=0 ORDER BY id ASC LIMIT {}",
+            fetchLimit));
+        if (!result)
+        {
+            _outboxHandled.clear();
+            return 0;
+        }
+
+        static std::atomic<uint64>& deferred = Metrics::Instance().Get("send_queue.outbox_deferred");
+        uint32 rows = 0;
+        uint64 fetched = 0;
+        uint32 lastId = 0;
+        bool stopped = false;
+        std::vector<uint32> heldIds;
+        std::vector<uint32> stillPending;
+
+        do
+        {
+            Field* fields = result->Fetch();
+            uint32 id = fields[0].Get<uint32>();
+            ++fetched;
+            lastId = id;
+            if (_outboxHandled.count(id))
+            {
+                stillPending.push_back(id);
+                continue;
+            }
+
+            // Views into the result set; valid until the next query.
+            std::string_view eventType = fields[1].Get<std::string_view>();
+            std::string_view payload = fields[2].Get<std::string_view>();
+
+            uint32 ticketId = 0;
+            bool hasTicketId = false;
+            if (eventType.substr(0, 7) == "ticket_")
+            {
+                std::string_view ticketBlock;
+                if (ExtractJsonBlock(payload, "ticket", ticketBlock))
+                    hasTicketId = ExtractJsonUint(ticketBlock, "id", ticketId);
+            }
+            else if (eventType == "player_whisper" || eventType == "gm_whisper")
+            {
+                std::string_view whisperBlock;
+                if (ExtractJsonBlock(payload, "whisper", whisperBlock))
+                    hasTicketId = ExtractJsonUint(whisperBlock, "ticketId", ticketId);
+            }
+
+            TicketLink link;
+            if (hasTicketId)
+                TicketLinkCache::Instance().Get(ticketId, link);
+
+            bool roomsEnabled = settings.ticketRoomsEnabled && hasTicketId && settings.ticketRoomCategoryId && settings.guildId;
+            uint64_t roomChannelId = 0;
+            if (roomsEnabled)
+                GetTicketRoomChannel(ticketId, roomChannelId);
+
+            // A full send queue would drop the post after the row is marked;
+            // leave this row and the rest undispatched for a later pass.
+            if (!HasSendRoom({ settings.outboxChannelId, settings.alertChannelId, settings.escalationChannelId,
+                settings.digestChannelId, link.threadId, roomChannelId }))
+            {
+                deferred.fetch_add(1, std::memory_order_relaxed);
+                stopped = true;
+                break;
+            }
+
+            _outboxHandled.insert(id);
+            ++rows;
+
+            if (hasTicketId && settings.searchEnabled)
+                IndexOutboxEvent(eventType, payload, ticketId);
+
+            dpp::embed embed;
+            bool hasEmbed = false;
+            // GM replies are already visible in Discord; the row only exists
+            // for the close transcript.
+            if (eventType == "command_result" || eventType == "gm_whisper")
+            {
+                MarkOutboxDispatched(id);
+                continue;
+            }
+            else if (eventType == "player_whisper")
+                hasEmbed = BuildWhisperEmbed(eventType, payload, embed);
+            else if (eventType.rfind("ticket_", 0) == 0)
+                hasEmbed = BuildTicketEmbed(eventType, payload, embed);
+
+            if (eventType == "alert")
+            {
+                uint64_t channelId = settings.alertChannelId ? settings.alertChannelId : settings.outboxChannelId;
+                std::string summary;
+                if (channelId && ExtractJsonString(payload, "summary", summary))
+                {
+                    dpp::embed alertEmbed;
+                    alertEmbed.set_title("Game alerts");
+                    alertEmbed.set_description(TruncateForDiscord(summary));
+                    alertEmbed.set_color(0xEB5757);
+                    QueueMessage(dpp::message(channelId, "").add_embed(alertEmbed));
+                }
+                MarkOutboxDispatched(id);
+                continue;
+            }
+
+            // Escalations are alerts, not ticket state: never edit the ticket
+            // message or post to the room, just ping.
+            if (eventType == "ticket_escalation")
+            {
+                uint64_t channelId = settings.escalationChannelId ? settings.escalationChannelId : settings.outboxChannelId;
+                uint64_t createTime = 0;
+                ExtractJsonArithmetic(payload, "createTime", createTime);
+                uint64_t now = static_cast<uint64_t>(std::time(nullptr));
+                std::string content = Acore::StringFormat("Ticket #{} has waited {} min without a response.",
+                    ticketId, now > createTime ? (now - createTime) / 60 : 0);
+
+                // Ping the GMs who are on Discord right now; the role only
+                // when nobody is.
+                std::string mentions;
+                for (uint64_t discordUserId : GmPresence::Instance().GetDiscordReachable())
+                    mentions += Acore::StringFormat("<@{}> ", discordUserId);
+                if (!mentions.empty())
+                    content = mentions + content;
+                else if (settings.escalationRoleId)
+                    content = Acore::StringFormat("<@&{}> {}", settings.escalationRoleId, content);
+
+                if (channelId)
+                {
+                    dpp::message alert(channelId, content);
+                    if (hasEmbed)
+                        alert.add_embed(embed);
+                    QueueMessage(alert);
+                }
+
+                if (link.threadId)
+                    QueueMessage(dpp::message(link.threadId, content));
+
+                MarkOutboxDispatched(id);
+                continue;
+            }
+
+            // Before the close branch below forgets the thread.
+            if (eventType == "ticket_close" && hasTicketId && settings.transcriptEnabled)
+            {
+                uint64_t channelId = 0;
+                if (!settings.ticketRoomsEnabled || !GetTicketRoomChannel(ticketId, channelId))
+                    channelId = settings.outboxChannelId;
+                ExportTranscript(ticketId, link.threadId, channelId);
+            }
+
+            // Digested events skip their own posts; thread and room
+            // bookkeeping below still runs.
+            bool digested = hasTicketId && settings.digestEvents.count(std::string(eventType));
+            if (digested)
+            {
+                AddToDigest(id, ticketId, eventType, payload);
+                heldIds.push_back(id);
+            }
+
+            if (settings.outboxChannelId && !digested)
+            {
+                if (eventType == "player_whisper")
+                {
+                    if (link.threadId)
+                    {
+                        if (hasEmbed)
+                            QueueMessage(dpp::message(link.threadId, "").add_embed(embed));
+                        else
+                            QueueMessage(dpp::message(link.threadId, TruncateForDiscord(Acore::StringFormat("[{}] {}", eventType, payload))));
+                    }
+                    MarkOutboxDispatched(id);
+                    continue;
+                }
+
+                bool createThread = (eventType == "ticket_create" && hasTicketId);
+                bool isTicketUpdate = (eventType.rfind("ticket_", 0) == 0 && eventType != "ticket_create" && hasTicketId);
+                bool editedMessage = false;
+
+                if (isTicketUpdate)
+                {
+                    if (link.messageId)
+                    {
+                        dpp::message editMessage(settings.outboxChannelId, "");
+                        editMessage.id = link.messageId;
+                        if (hasEmbed)
+                            editMessage.add_embed(embed);
+                        else
+                            editMessage.set_content(TruncateForDiscord(Acore::StringFormat("[{}] {}", eventType, payload)));
+
+                        QueueEdit(editMessage);
+                        editedMessage = true;
+                    }
+                }
+
+                if (editedMessage)
+                {
+                }
+                else if (createThread)
+                {
+                    std::string playerName;
+                    if (!ExtractJsonString(payload, "player", playerName))
+                        playerName = "player";
+
+                    std::string threadName = FormatTicketRoomName("ticket-{id}-{player}", playerName, ticketId);
+                    dpp::message outMessage = hasEmbed
+                        ? dpp::message(settings.outboxChannelId, "").add_embed(embed)
+                        : dpp::message(settings.outboxChannelId, TruncateForDiscord(Acore::StringFormat("[{}] {}", eventType, payload)));
+
+                    QueueMessage(outMessage, [this, clusterPtr, threadName, ticketId](const dpp::confirmation_callback_t& cb)
+                    {
+                        if (cb.is_error())
+                            return;
+
+                        auto created = std::get<dpp::message>(cb.value);
+                        TicketLinkCache::Instance().SetMessage(ticketId, static_cast<uint64_t>(created.id));
+                        clusterPtr->thread_create_with_message(threadName, created.channel_id, created.id, 1440, 0,
+                            TrackRequest(_inflight, [this, clusterPtr, ticketId](const dpp::confirmation_callback_t& threadCb)
+                            {
+                                if (threadCb.is_error())
+                                    return;
+
+                            auto createdThread = std::get<dpp::thread>(threadCb.value);
+                            uint64_t threadId = static_cast<uint64_t>(createdThread.id);
+                            TicketLinkCache::Instance().SetThread(ticketId, threadId);
+
+                            dpp::message panelMessage(threadId, "GM Controls");
+                            for (dpp::component const& row : BuildTicketPanelComponents(ticketId))
+                                panelMessage.add_component(row);
+                            QueueMessage(panelMessage);
+                            }));
+                    });
+                }
+                else if (hasEmbed)
+                {
+                    if (hasTicketId && eventType.rfind("ticket_", 0) == 0)
+                    {
+                        QueueMessage(dpp::message(settings.outboxChannelId, "").add_embed(embed),
+                            [this, ticketId](const dpp::confirmation_callback_t& cb)
+                            {
+                                if (!cb.is_error())
+                                {
+                                    auto created = std::get<dpp::message>(cb.value);
+                                    TicketLinkCache::Instance().SetMessage(ticketId, static_cast<uint64_t>(created.id));
+                                }
+                            });
+                    }
+                    else
+                    {
+                        QueueMessage(dpp::message(settings.outboxChannelId, "").add_embed(embed));
+                    }
+                }
+                else
+                {
+                    std::string content = TruncateForDiscord(Acore::StringFormat("[{}] {}", eventType, payload));
+                    if (hasTicketId && eventType.rfind("ticket_", 0) == 0)
+                    {
+                        QueueMessage(dpp::message(settings.outboxChannelId, content),
+                            [this, ticketId](const dpp::confirmation_callback_t& cb)
+                            {
+                                if (!cb.is_error())
+                                {
+                                    auto created = std::get<dpp::message>(cb.value);
+                                    TicketLinkCache::Instance().SetMessage(ticketId, static_cast<uint64_t>(created.id));
+                                }
+                            });
+                    }
+                    else
+                    {
+                        QueueMessage(dpp::message(settings.outboxChannelId, content));
+                    }
+                }
+            }
+
+            if (roomsEnabled)
+            {
+                uint64_t channelId = roomChannelId;
+
+                if (channelId == 0 && eventType == "ticket_create")
+                {
+                    std::string playerName;
+                    if (!ExtractJsonString(payload, "player", playerName))
+                        playerName = "player";
+                    std::string channelName = FormatTicketRoomName(settings.ticketRoomNameFormat, playerName, ticketId);
+
+                    dpp::channel channel;
+                    channel.set_name(channelName);
+                    channel.set_type(dpp::CHANNEL_TEXT);
+                    channel.set_parent_id(settings.ticketRoomCategoryId);
+
+                    std::vector<dpp::permission_overwrite> overwrites;
+
+                    std::vector<uint64_t> allowedRoles = settings.ticketRoomRoleIds;
+                    bool allowEveryone = allowedRoles.empty();
+                    if (!allowEveryone)
+                    {
+                        dpp::permission_overwrite everyone;
+                        everyone.id = settings.guildId;
+                        everyone.type = dpp::ot_role;
+                        everyone.allow = 0;
+                        everyone.deny = dpp::p_view_channel;
+                        overwrites.push_back(everyone);
+                    }
+                    else
+                    {
+                        allowedRoles.push_back(settings.guildId);
+                    }
+
+                    for (uint64_t roleId : allowedRoles)
+                    {
+                        dpp::permission_overwrite roleOverwrite;
+                        roleOverwrite.id = roleId;
+                        roleOverwrite.type = dpp::ot_role;
+                        roleOverwrite.allow = dpp::p_view_channel | dpp::p_send_messages | dpp::p_read_message_history;
+                        roleOverwrite.deny = 0;
+                        overwrites.push_back(roleOverwrite);
+                    }
+
+                    channel.permission_overwrites = overwrites;
+
+                    uint64_t guildId = settings.guildId;
+                    clusterPtr->channel_create(channel, TrackRequest(_inflight, [ticketId, guildId](const dpp::confirmation_callback_t& cb)
+                    {
+                        if (!cb.is_error())
+                        {
+                            auto created = std::get<dpp::channel>(cb.value);
+                            UpsertTicketRoom(ticketId, static_cast<uint64_t>(created.id), guildId);
+                        }
+                    }));
+
+                }
+
+                if (channelId != 0 && settings.ticketRoomPostUpdates && !digested)
+                {
+                    if (hasEmbed)
+                        QueueMessage(dpp::message(channelId, "").add_embed(embed));
+                    else
+                        QueueMessage(dpp::message(channelId, TruncateForDiscord(Acore::StringFormat("[{}] {}", eventType, payload))));
+                }
+
+                if (eventType == "ticket_close" || eventType == "ticket_resolve")
+                {
+                    if (link.threadId)
+                    {
+                        clusterPtr->thread_get(link.threadId, TrackRequest(_inflight, [this, clusterPtr](const dpp::confirmation_callback_t& cb)
+                        {
+                            if (cb.is_error())
+                                return;
+
+                            auto threadInfo = std::get<dpp::thread>(cb.value);
+                            threadInfo.metadata.auto_archive_duration = 1440;
+                            threadInfo.metadata.archived = true;
+                            threadInfo.metadata.locked = true;
+                            clusterPtr->thread_edit(threadInfo, TrackRequest(_inflight));
+                        }));
+                        TicketLinkCache::Instance().ClearThread(ticketId);
+                    }
+
+                    if (settings.ticketRoomArchiveOnClose && channelId != 0)
+                    {
+                        dpp::channel ch;
+                        ch.id = channelId;
+                        if (settings.ticketRoomArchiveCategoryId)
+                            ch.set_parent_id(settings.ticketRoomArchiveCategoryId);
+
+                        if (!hasEmbed)
+                        {
+                            QueueMessage(dpp::message(channelId, "Ticket closed."));
+                        }
+
+                        clusterPtr->channel_edit(ch, TrackRequest(_inflight));
+                        MarkTicketRoomArchived(ticketId);
+                    }
+                }
+            }
+
+            if (!digested)
+                MarkOutboxDispatched(id);
+        } while (result->NextRow());
+
+        // A handled id the scan passed over without seeing has its UPDATE
+        // applied; forget it. Rows come back in id order, so stillPending
+        // is sorted. A scan that hit the limit says nothing past it.
+        if (!stopped)
+        {
+            bool exhausted = fetched < fetchLimit;
+            for (auto itr = _outboxHandled.begin(); itr != _outboxHandled.end();)
+            {
+                if ((exhausted || *itr <= lastId) && !std::binary_search(stillPending.begin(), stillPending.end(), *itr))
+                    itr = _outboxHandled.erase(itr);
+                else
+                    ++itr;
+            }
+        }
+
+        // Held until PostDigest; restarts pick them up again. Only undispatched
+        // rows move, so this cannot undo a digest that already landed.
+        if (!heldIds.empty())
+        {
+            std::string ids;
+            for (uint32 heldId : heldIds)
+                ids += Acore::StringFormat("{}{}", ids.empty() ? "" : ",", heldId);
+            SpillQueue::Instance().Execute(Acore::StringFormat(
+                "UPDATE gm_discord_outbox SET dispatched=2 WHERE dispatched=0 AND id IN ({})", ids));
+        }
+
+        PumpSendQueue();
+        return rows;
+#endif
+    }
+
+    void DiscordBot::AddToDigest(uint32_t outboxId, uint32_t ticketId, std::string_view eventType, std::string_view payload)
+    {
+        DigestTicket& entry = _digest[ticketId];
+        entry.outboxIds.push_back(outboxId);
+
+        std::string_view ticketBlock;
+        if (!ExtractJsonBlock(payload, "ticket", ticketBlock))
+            return;
+
+        std::string assignee;
+        ExtractJsonString(ticketBlock, "assignedTo", assignee);
+        if (entry.player.empty())
+        {
+            ExtractJsonString(ticketBlock, "player", entry.player);
+            entry.firstAssignee = assignee;
+        }
+        entry.lastAssignee = assignee;
+
+        if (eventType == "ticket_update")
+            ++entry.updates;
+        else if (eventType == "ticket_status")
+            ++entry.statusChanges;
+        else if (eventType == "ticket_close")
+            entry.closed = true;
+        else if (eventType == "ticket_resolve")
+            entry.resolved = true;
+    }
+
+    void DiscordBot::LoadDigest()
+    {
+        std::lock_guard<std::mutex> guard(_dispatchMutex);
+        QueryResult result = ModuleDB().Query("SELECT id, event_type, payload FROM gm_discord_outbox WHERE dispatched=2 ORDER BY id ASC");
+        if (!result)
+            return;
+
+        do
+        {
+            Field* fields = result->Fetch();
+            uint32 outboxId = fields[0].Get<uint32>();
+            std::string_view eventType = fields[1].Get<std::string_view>();
+            std::string_view payload = fields[2].Get<std::string_view>();
+            std::string_view ticketBlock;
+            uint32 ticketId = 0;
+            if (ExtractJsonBlock(payload, "ticket", ticketBlock) && ExtractJsonUint(ticketBlock, "id", ticketId))
+                AddToDigest(outboxId, ticketId, eventType, payload);
+            else
+                MarkOutboxDispatched(outboxId);
+        } while (result->NextRow());
+    }
+
+    void DiscordBot::PostDigest()
+    {
+        std::lock_guard<std::mutex> guard(_dispatchMutex);
+        if (_digest.empty())
+            return;
+
+        Settings const& settings = _settings.Get();
+        uint32 updated = 0;
+        uint32 statusChanged = 0;
+        uint32 closed = 0;
+        uint32 resolved = 0;
+        uint32 reassigned = 0;
+        std::string lines;
+        std::string ids;
+        for (auto const& [ticketId, entry] : _digest)
+        {
+            for (uint32 outboxId : entry.outboxIds)
+                ids += Acore::StringFormat("{}{}", ids.empty() ? "" : ",", outboxId);
+
+            std::vector<std::string> what;
+            if (entry.updates)
+            {
+                ++updated;
+                what.push_back(entry.updates > 1 ? Acore::StringFormat("updated x{}", entry.updates) : "updated");
+            }
+            if (entry.statusChanges)
+            {
+                ++statusChanged;
+                what.push_back("status changed");
+            }
+            if (entry.firstAssignee != entry.lastAssignee)
+            {
+                ++reassigned;
+                what.push_back(Acore::StringFormat("assigned to {}", entry.lastAssignee.empty() ? "nobody" : entry.lastAssignee));
+            }
+            if (entry.resolved)
+            {
+                ++resolved;
+                what.push_back("resolved");
+            }
+            if (entry.closed)
+            {
+                ++closed;
+                what.push_back("closed");
+            }
+            if (what.empty())
+                continue;
+
+            std::string linkText;
+            TicketLink link;
+            TicketLinkCache::Instance().Get(ticketId, link);
+            if (link.threadId)
+                linkText = Acore::StringFormat(" <#{}>", link.threadId);
+            else if (link.messageId && settings.guildId)
+                linkText = Acore::StringFormat(" [message](https://discord.com/channels/{}/{}/{})", settings.guildId, settings.outboxChannelId, link.messageId);
+
+            std::string joined;
+            for (std::string const& item : what)
+                joined += (joined.empty() ? "" : ", ") + item;
+            lines += Acore::StringFormat("**#{}** {}: {}{}\n", ticketId, entry.player.empty() ? "unknown" : entry.player, joined, linkText);
+        }
+
+        std::string summary;
+        auto addCount = [&summary](uint32 count, char const* label)
+        {
+            if (count)
+                summary += Acore::StringFormat("{}{} {}", summary.empty() ? "" : ", ", count, label);
+        };
+        addCount(updated, updated == 1 ? "ticket updated" : "tickets updated");
+        addCount(statusChanged, statusChanged == 1 ? "status change" : "status changes");
+        addCount(reassigned, "reassigned");
+        addCount(resolved, "resolved");
+        addCount(closed, "closed");
+
+        uint64_t channelId = settings.digestChannelId ? settings.digestChannelId : settings.outboxChannelId;
+#if GM_DISCORD_HAVE_DPP
+        if (channelId)
+        {
+            dpp::embed embed;
+            embed.set_title("Ticket digest");
+            embed.set_description(TruncateForDiscord(Acore::StringFormat("{}\n\n{}", summary, lines)));
+            embed.set_color(0x2D9CDB);
+            QueueMessage(dpp::message(channelId, "").add_embed(embed));
+        }
+#else
+        (void)channelId;
+#endif
+
+        SpillQueue::Instance().Execute(Acore::StringFormat(
+            "UPDATE gm_discord_outbox SET dispatched=1, dispatched_at=NOW() WHERE id IN ({})", ids));
+        _digest.clear();
+    }
+
+    void DiscordBot::RegisterCommands(uint64_t appId)
+    {
+#if !GM_DISCORD_HAVE_DPP
+        (void)appId;
+#else
+        auto* clusterPtr = static_cast<dpp::cluster*>(_cluster);
+        if (!clusterPtr)
+            return;
+
+        Settings const& settings = _settings.Get();
+
+        dpp::slashcommand auth("gm-auth", "Link your GM account", appId);
+        auth.add_option(dpp::command_option(dpp::co_string, "secret", "Secret from in-game .discord link", true));
+
+        dpp::slashcommand command("gm-command", "Execute GM command", appId);
+        command.add_option(dpp::command_option(dpp::co_string, "command", "GM command, e.g. .ticket list", true));
+
+        dpp::slashcommand whisper("gm-whisper", "Whisper a player as your GM name", appId);
+        whisper.add_option(dpp::command_option(dpp::co_string, "player", "Player name", true));
+        whisper.add_option(dpp::command_option(dpp::co_string, "message", "Message to send", true));
+
+        dpp::slashcommand assign("gm-ticket-assign", "Assign a ticket to a GM", appId);
+        assign.add_option(dpp::command_option(dpp::co_integer, "ticket_id", "Ticket ID", true).set_auto_complete(true));
+        assign.add_option(dpp::command_option(dpp::co_string, "gm_name", "GM character name", true));
+
+        dpp::slashcommand stats("gm-stats", "Show module statistics", appId);
+        stats.add_option(dpp::command_option(dpp::co_sub_command, "metrics", "Module counters and gauges"));
+        stats.add_option(dpp::command_option(dpp::co_sub_command, "tickets", "Ticket response, assign and close times"));
+
+        dpp::slashcommand online("gm-online", "Show which linked GMs are in game or on Discord", appId);
+
+        dpp::slashcommand search("gm-ticket-search", "Search ticket and whisper history", appId);
+        search.add_option(dpp::command_option(dpp::co_string, "query", "Words to look for, e.g. a player or item name", true));
+
+        std::vector<dpp::slashcommand> commands = { auth, command, whisper, assign, stats, online, search };
+        uint64_t signature = GetCommandSignature(commands, settings.guildId);
+
+        // Discord keeps registered commands across sessions and restarts, so
+        // only a changed definition set (or a failed last attempt) is sent.
+        if (!_commandSignature.load(std::memory_order_acquire))
+            _commandSignature.store(LoadCommandSignature(), std::memory_order_release);
+        if (_commandSignature.load(std::memory_order_acquire) == signature)
+            return;
+
+        auto onRegistered = [this, signature](dpp::confirmation_callback_t const& cb)
+        {
+            if (cb.is_error())
+            {
+                LOG_WARN("module.gm_discord", "Discord command registration failed: {}", EscapeFmtBraces(cb.get_error().message));
+                return;
+            }
+
+            _commandSignature.store(signature, std::memory_order_release);
+            SaveCommandSignature(signature);
+            LOG_INFO("module.gm_discord", "Discord commands registered.");
+        };
+
+        // Bulk registration overwrites the whole set, which also drops
+        // commands an older build registered and this one no longer has.
+        if (settings.guildId)
+            clusterPtr->guild_bulk_command_create(commands, settings.guildId, onRegistered);
+        else
+            clusterPtr->global_bulk_command_create(commands, onRegistered);
+#endif
+    }
+
+    void DiscordBot::PumpSendQueue()
+    {
+#if GM_DISCORD_HAVE_DPP
+        static std::atomic<uint64>& pending = Metrics::Instance().Get("send_queue.pending");
+        static std::atomic<uint64>& mergedTotal = Metrics::Instance().Get("send_queue.merged");
+        static std::atomic<uint64>& rateLimited = Metrics::Instance().Get("send_queue.rate_limited");
+
+        auto* clusterPtr = static_cast<dpp::cluster*>(_cluster);
+        if (!clusterPtr)
+            return;
+
+        uint64_t merged = 0;
+        for (SendQueue::Ready& ready : GetSendQueue().TakeReady(GetSteadyMs(), MergeMessages, merged))
+        {
+            uint64_t channelId = ready.channelId;
+            auto onSent = TrackRequest(_inflight,
+                [channelId, callback = std::move(ready.callback)](const dpp::confirmation_callback_t& cb)
+                {
+                    // DPP retries it; keep the rest of this channel back for a window.
+                    if (cb.is_error() && cb.http_info.status == 429)
+                    {
+                        rateLimited.fetch_add(1, std::memory_order_relaxed);
+                        GetSendQueue().Defer(channelId, GetSteadyMs() + SendQueue::WINDOW_MS);
+                    }
+                    if (callback)
+                        callback(cb);
+                });
+
+            if (ready.edit)
+                clusterPtr->message_edit(ready.message, onSent);
+            else
+                clusterPtr->message_create(ready.message, onSent);
+        }
+
+        mergedTotal.fetch_add(merged, std::memory_order_relaxed);
+        pending.store(GetSendQueue().GetPending(), std::memory_order_relaxed);
+#endif
+    }
+
+    void DiscordBot::ExportTranscript(uint32_t ticketId, uint64_t threadId, uint64_t channelId)
+    {
+#if !GM_DISCORD_HAVE_DPP
+        (void)ticketId;
+        (void)threadId;
+        (void)channelId;
+#else
+        auto* clusterPtr = static_cast<dpp::cluster*>(_cluster);
+        if (!clusterPtr || !channelId)
+            return;
+
+        std::string directory = _settings.Get().transcriptDirectory;
+        std::vector<TranscriptLine> lines = LoadTicketEvents(ticketId);
+        auto finish = [this, clusterPtr, ticketId, channelId, directory](std::vector<TranscriptLine> lines)
+        {
+            std::string path = WriteTranscript(directory, ticketId, std::move(lines));
+            std::string contents;
+            if (path.empty() || !ReadTranscriptFile(path, contents))
+                return;
+
+            dpp::message archive(channelId, Acore::StringFormat("Ticket #{} closed; transcript attached.", ticketId));
+            archive.add_file(std::filesystem::path(path).filename().string(), contents, "application/gzip");
+            QueueMessage(archive);
+        };
+
+        if (!threadId)
+        {
+            finish(std::move(lines));
+            return;
+        }
+
+        // A thread reply that reached the player also has its gm_whisper row.
+        FetchThreadMessages(clusterPtr, _inflight, threadId, 0, std::move(lines), finish);
+#endif
+    }
+
+    void DiscordBot::PublishStatus()
+    {
+#if GM_DISCORD_HAVE_DPP
+        Settings const& settings = _settings.Get();
+        auto* clusterPtr = static_cast<dpp::cluster*>(_cluster);
+        if (!clusterPtr || !settings.statusChannelId)
+            return;
+
+        std::lock_guard<std::mutex> statusGuard(_statusMutex);
+
+        // First tick: adopt the status message a previous run left behind
+        // instead of posting another one, then publish from the callback
+        // rather than a full interval later.
+        if (!_statusLookupDone)
+        {
+            if (_statusLookupStarted)
+                return;
+
+            _statusLookupStarted = true;
+            uint64_t botUserId = 0;
+            std::from_chars(settings.botId.data(), settings.botId.data() + settings.botId.size(), botUserId);
+            clusterPtr->messages_get(settings.statusChannelId, 0, 0, 0, 50, TrackRequest(_inflight,
+                [this, botUserId](const dpp::confirmation_callback_t& cb)
+                {
+                    if (!cb.is_error())
+                    {
+                        for (auto const& [messageId, message] : std::get<dpp::message_map>(cb.value))
+                            if (message.author.id == botUserId && !message.embeds.empty() && message.embeds[0].title == STATUS_EMBED_TITLE
+                                && static_cast<uint64_t>(messageId) > _statusMessageId)
+                                _statusMessageId = static_cast<uint64_t>(messageId);
+                    }
+
+                    {
+                        std::lock_guard<std::mutex> guard(_statusMutex);
+                        _statusLookupDone = true;
+                    }
+
+                    if (_running)
+                        PublishStatus();
+                }));
+            return;
+        }
+
+        std::unordered_map<std::string, uint64_t> values;
+        for (auto const& [metric, value] : Metrics::Instance().Snapshot())
+            values.emplace(metric, value);
+        auto get = [&values](std::string const& metric)
+        {
+            auto it = values.find(metric);
+            return it != values.end() ? it->second : 0;
+        };
+
+        std::string players = Acore::StringFormat("{} online, {} queued", get("world.players"), get("world.queued_sessions"));
+        std::string tickets = Acore::StringFormat("{} open", get("world.open_tickets"));
+        std::string update = Acore::StringFormat("p50 {} ms, p99 {} ms", get("world.update_diff_p50_ms"), get("world.update_diff_p99_ms"));
+        // A relative timestamp renders client side, so uptime alone never forces an edit.
+        std::string uptime = Acore::StringFormat("<t:{}:R>", get("world.start_time"));
+        std::string backlogs = Acore::StringFormat("inbox {}, DB queue {}, spilled {}",
+            get("inbox.backlog") ? "behind" : "clear", get("db.character_queue"), get("spill.pending"));
+
+        std::string body = players + "\n" + tickets + "\n" + update + "\n" + uptime + "\n" + backlogs;
+        uint64_t messageId = _statusMessageId;
+        if (messageId && body == _statusLastBody)
+            return;
+        _statusLastBody = body;
+
+        dpp::embed embed;
+        embed.set_title(STATUS_EMBED_TITLE);
+        embed.set_color(0x2D9CDB);
+        embed.add_field("Players", players, true);
+        embed.add_field("Tickets", tickets, true);
+        embed.add_field("World update", update, true);
+        embed.add_field("Up since", uptime, true);
+        embed.add_field("Backlogs", backlogs, false);
+        embed.set_timestamp(std::time(nullptr));
+
+        if (messageId)
+        {
+            dpp::message edit(settings.statusChannelId, "");
+            edit.id = messageId;
+            edit.add_embed(embed);
+            // Deleted by someone: post a fresh one next tick.
+            QueueEdit(edit, [this, messageId](const dpp::confirmation_callback_t& cb)
+            {
+                uint64_t expected = messageId;
+                if (cb.is_error())
+                    _statusMessageId.compare_exchange_strong(expected, 0);
+            });
+            return;
+        }
+
+        QueueMessage(dpp::message(settings.statusChannelId, "").add_embed(embed),
+            [this](const dpp::confirmation_callback_t& cb)
+            {
+                if (!cb.is_error())
+                    _statusMessageId = static_cast<uint64_t>(std::get<dpp::message>(cb.value).id);
+            });
+#endif
+    }
+
     void DiscordBot::Stop()
     {
-        if (!_enabled)
+        Settings const& settings = _settings.Get();
+        if (!settings.enabled)
             return;
 
 #if GM_DISCORD_HAVE_DPP
@@ -1488,7 +2622,61 @@ namespace GMDiscord
         LOG_INFO("module.gm_discord", "Discord bot stopping.");
         auto* clusterPtr = static_cast<dpp::cluster*>(_cluster);
         if (clusterPtr)
+        {
+            // New interactions get a "shutting down" reply from here on.
+            _accepting = false;
+            if (_outboxTimer)
+                clusterPtr->stop_timer(_outboxTimer);
+            _outboxTimer = 0;
+            if (_statusTimer)
+                clusterPtr->stop_timer(_statusTimer);
+            _statusTimer = 0;
+            if (_logRelayTimer)
+                clusterPtr->stop_timer(_logRelayTimer);
+            _logRelayTimer = 0;
+            if (_sendQueueTimer)
+                clusterPtr->stop_timer(_sendQueueTimer);
+            _sendQueueTimer = 0;
+            if (_digestTimer)
+                clusterPtr->stop_timer(_digestTimer);
+            _digestTimer = 0;
+            LogRelay::Instance().SetEnabled(false);
+
+            // Flush queued outbox rows and wait for in-flight REST calls until
+            // the deadline; spilled writes must land before their rows can be read.
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(settings.shutdownDrainMs);
+            while (std::chrono::steady_clock::now() < deadline)
+            {
+                uint32 dispatched = settings.outboxChannelId ? DispatchOutbox(50) : 0;
+                // Held events go out now rather than wait for the restart.
+                if (!dispatched)
+                    PostDigest();
+                PumpSendQueue();
+                if (!dispatched && !GetSendQueue().GetPending() && !_inflight.load(std::memory_order_acquire) &&
+                    !SpillQueue::Instance().GetPendingCount())
+                    break;
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+
+            uint64 undispatched = 0;
+            if (!SpillQueue::Instance().IsDegraded())
+            {
+                if (QueryResult result = ModuleDB().Query("SELECT COUNT(*) FROM gm_discord_outbox WHERE dispatched=0"))
+                    undispatched = (*result)[0].Get<uint64>();
+            }
+
+            uint32 inflight = _inflight.load(std::memory_order_acquire);
+            size_t queued = GetSendQueue().GetPending();
+            size_t spilled = SpillQueue::Instance().GetPendingCount();
+            if (undispatched || queued || inflight || spilled)
+                LOG_WARN("module.gm_discord", "Discord bot shutdown drain left {} undispatched outbox events, {} queued messages, {} in-flight requests and {} spilled statements.",
+                    undispatched, queued, inflight, spilled);
+            else
+                LOG_INFO("module.gm_discord", "Discord bot shutdown drain completed.");
+
             clusterPtr->shutdown();
+        }
 
         if (_thread.joinable())
             _thread.join();
@@ -18,15 +18,32 @@
 #ifndef MOD_GM_DISCORD_BOT_H
 #define MOD_GM_DISCORD_BOT_H
 
+#include "GMDiscordFlatMap.h"
+#include "GMDiscordSettings.h"
+
 #include <atomic>
 #include <cstdint>
+#include <map>
+#include <mutex>
+#include <set>
 #include <string>
+#include <string_view>
 #include <thread>
-#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace GMDiscord
 {
+    // GMDiscord.Bot.RoleMappings: each category is a bit, each role id maps
+    // to the mask of its categories. Checked on every interaction.
+    struct RoleCategoryTable
+    {
+        static constexpr size_t MAX_CATEGORIES = 32;
+
+        std::vector<std::string> categories;
+        SortedIdTable<uint32_t> roleMasks;
+    };
+
     class DiscordBot
     {
     public:
@@ -36,32 +53,112 @@ namespace GMDiscord
         void Start();
         void Stop();
 
-        bool IsEnabled() const { return _enabled; }
-        std::string const& GetBotId() const { return _botId; }
+        bool IsEnabled() const { return _settings.Get().enabled; }
+        std::string const& GetBotId() const { return _settings.Get().botId; }
 
     private:
+        // Published by LoadConfig; DPP handlers read it with one acquire load.
+        struct Settings
+        {
+            bool enabled = false;
+            std::string botId;
+            std::string botToken;
+            uint64_t guildId = 0;
+            uint64_t outboxChannelId = 0;
+            bool ticketRoomsEnabled = false;
+            uint64_t ticketRoomCategoryId = 0;
+            uint64_t ticketRoomArchiveCategoryId = 0;
+            std::string ticketRoomNameFormat;
+            bool ticketRoomPostUpdates = true;
+            bool ticketRoomArchiveOnClose = true;
+            // Roles granted access to ticket rooms: AllowedRoles, else every mapped role.
+            std::vector<uint64_t> ticketRoomRoleIds;
+            RoleCategoryTable roleCategoryMap;
+            uint32_t shutdownDrainMs = 5000;
+            // Escalations go here (else the outbox channel) and ping this role.
+            uint64_t escalationChannelId = 0;
+            uint64_t escalationRoleId = 0;
+            // Batched game alerts (AlertPipeline) go here, else the outbox channel.
+            uint64_t alertChannelId = 0;
+            bool transcriptEnabled = false;
+            std::string transcriptDirectory;
+            // Subscribe to guild presences (privileged intent) for GmPresence.
+            bool presenceEnabled = false;
+            // One status embed here, edited every statusIntervalSeconds.
+            uint64_t statusChannelId = 0;
+            uint32_t statusIntervalSeconds = 60;
+            // Batched log lines from the Discord appender, one message per interval.
+            uint64_t logRelayChannelId = 0;
+            uint32_t logRelayIntervalSeconds = 5;
+            bool searchEnabled = false;
+            std::string searchIndexFile;
+            // Ticket events summarized every digestIntervalMinutes instead
+            // of posted one by one (empty = digest off).
+            std::unordered_set<std::string> digestEvents;
+            uint32_t digestIntervalMinutes = 60;
+            uint64_t digestChannelId = 0;
+        };
+
+        // What happened to one ticket since the last digest.
+        struct DigestTicket
+        {
+            std::string player;
+            std::string firstAssignee;
+            std::string lastAssignee;
+            uint32_t updates = 0;
+            uint32_t statusChanges = 0;
+            bool closed = false;
+            bool resolved = false;
+            // Held outbox rows; PostDigest marks exactly these dispatched.
+            std::vector<uint32_t> outboxIds;
+        };
+
         DiscordBot() = default;
 
-        bool _enabled = false;
-        std::string _botId;
-        std::string _botToken;
-        uint64_t _guildId = 0;
-        uint64_t _outboxChannelId = 0;
-        bool _ticketRoomsEnabled = false;
-        uint64_t _ticketRoomCategoryId = 0;
-        uint64_t _ticketRoomArchiveCategoryId = 0;
-        std::string _ticketRoomNameFormat;
-        bool _ticketRoomPostUpdates = true;
-        bool _ticketRoomArchiveOnClose = true;
-        std::unordered_set<uint64_t> _ticketRoomAllowedRoleIds;
-        std::unordered_map<uint32_t, uint64_t> _ticketThreadIds;
-        std::unordered_map<uint64_t, uint32_t> _threadTicketIds;
-        std::unordered_map<uint32_t, uint64_t> _ticketMessageIds;
-        std::string _roleMappingsRaw;
+        // Posts up to `limit` undispatched outbox rows; returns rows handled.
+        // Stops early, leaving rows undispatched, while a target channel's
+        // send queue is full.
+        uint32_t DispatchOutbox(uint32_t limit);
+        // Writes the closed ticket's transcript and posts it to `channelId`.
+        void ExportTranscript(uint32_t ticketId, uint64_t threadId, uint64_t channelId);
+        // Adds one held outbox event to the pending digest.
+        void AddToDigest(uint32_t outboxId, uint32_t ticketId, std::string_view eventType, std::string_view payload);
+        // Re-reads events held (dispatched=2) before a restart.
+        void LoadDigest();
+        // Posts the digest and marks its held rows dispatched in one statement.
+        void PostDigest();
+        // Registers the slash commands unless Discord already has this set.
+        void RegisterCommands(uint64_t appId);
+        // Posts what each channel's send queue allows right now.
+        void PumpSendQueue();
+        // Renders the status embed from Metrics; edits only when it changed.
+        void PublishStatus();
 
-        std::unordered_map<uint64_t, std::unordered_set<std::string>> _roleCategoryMap;
+        SettingsSnapshot<Settings> _settings;
 
         std::atomic_bool _running{false};
+        std::atomic_bool _accepting{false};
+        std::atomic<uint32_t> _inflight{0};
+        std::mutex _dispatchMutex;
+        uint64_t _outboxTimer = 0;
+        uint64_t _statusTimer = 0;
+        uint64_t _logRelayTimer = 0;
+        uint64_t _sendQueueTimer = 0;
+        uint64_t _digestTimer = 0;
+        // Signature of the command set Discord last accepted; 0 = unknown.
+        std::atomic<uint64_t> _commandSignature{0};
+        // Guarded by _dispatchMutex.
+        std::map<uint32_t, DigestTicket> _digest;
+        // Outbox ids handled whose dispatched UPDATE has not shown up yet;
+        // guarded by _dispatchMutex.
+        std::set<uint32_t> _outboxHandled;
+        // Guarded by _statusMutex (the timer and the lookup callback both
+        // publish), except the id, which REST callbacks set.
+        std::mutex _statusMutex;
+        std::atomic<uint64_t> _statusMessageId{0};
+        bool _statusLookupStarted = false;
+        bool _statusLookupDone = false;
+        std::string _statusLastBody;
         std::thread _thread;
         void* _cluster = nullptr;
     };
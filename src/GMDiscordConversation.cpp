@@ -0,0 +1,164 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GMDiscordConversation.h"
+#include "GMDiscordDatabase.h"
+
+#include "Config.h"
+#include "DatabaseEnv.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace GMDiscord
+{
+    namespace
+    {
+        constexpr size_t MAX_LINE_LENGTH = 512;
+
+        bool StartsWithNoCase(std::string_view value, std::string_view prefix)
+        {
+            return value.size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), value.begin(), [](char a, char b)
+            {
+                return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+            });
+        }
+    }
+
+    ConversationBuffer& ConversationBuffer::Instance()
+    {
+        static ConversationBuffer instance;
+        return instance;
+    }
+
+    void ConversationBuffer::LoadConfig()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _maxLines = std::max<uint32>(1, sConfigMgr->GetOption<uint32>("GMDiscord.Conversation.Lines", 20));
+        _maxBytes = size_t(sConfigMgr->GetOption<uint32>("GMDiscord.Conversation.MaxKilobytes", 2048)) * 1024;
+    }
+
+    void ConversationBuffer::Load()
+    {
+        QueryResult result = ModuleDB().Query("SELECT id, name FROM gm_ticket WHERE type=0");
+        if (!result)
+            return;
+
+        do
+        {
+            Field* fields = result->Fetch();
+            Open(fields[0].Get<uint32>(), fields[1].Get<std::string>());
+        } while (result->NextRow());
+    }
+
+    void ConversationBuffer::Open(uint32_t ticketId, std::string_view player)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tickets[ticketId].player = player;
+    }
+
+    void ConversationBuffer::Close(uint32_t ticketId)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _tickets.find(ticketId);
+        if (it == _tickets.end())
+            return;
+
+        for (ConversationLine const& line : it->second.lines)
+            _bytes -= GetLineBytes(line);
+        if (it->second.listed)
+            _recent.erase(it->second.recent);
+        _tickets.erase(it);
+    }
+
+    void ConversationBuffer::Append(uint32_t ticketId, bool fromPlayer, std::string_view author, std::string_view text, uint64_t at)
+    {
+        if (!ticketId || text.empty())
+            return;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        Conversation& conversation = _tickets[ticketId];
+
+        ConversationLine& line = conversation.lines.emplace_back();
+        line.at = at;
+        line.fromPlayer = fromPlayer;
+        line.author = author;
+        line.text = text.substr(0, MAX_LINE_LENGTH);
+        _bytes += GetLineBytes(line);
+
+        if (conversation.listed)
+            _recent.splice(_recent.end(), _recent, conversation.recent);
+        else
+        {
+            conversation.recent = _recent.insert(_recent.end(), ticketId);
+            conversation.listed = true;
+        }
+
+        while (conversation.lines.size() > _maxLines)
+            PopOldest(conversation);
+
+        while (_bytes > _maxBytes && !_recent.empty())
+            PopOldest(_tickets[_recent.front()]);
+    }
+
+    void ConversationBuffer::PopOldest(Conversation& conversation)
+    {
+        _bytes -= GetLineBytes(conversation.lines.front());
+        conversation.lines.pop_front();
+        if (conversation.lines.empty() && conversation.listed)
+        {
+            _recent.erase(conversation.recent);
+            conversation.listed = false;
+        }
+    }
+
+    std::vector<ConversationLine> ConversationBuffer::GetLines(uint32_t ticketId) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _tickets.find(ticketId);
+        if (it == _tickets.end())
+            return {};
+
+        return { it->second.lines.begin(), it->second.lines.end() };
+    }
+
+    std::vector<OpenTicketPreview> ConversationBuffer::Find(std::string_view prefix, size_t limit) const
+    {
+        std::vector<OpenTicketPreview> matches;
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto const& [ticketId, conversation] : _tickets)
+        {
+            if (!prefix.empty() && !StartsWithNoCase(std::to_string(ticketId), prefix) && !StartsWithNoCase(conversation.player, prefix))
+                continue;
+
+            OpenTicketPreview& preview = matches.emplace_back();
+            preview.ticketId = ticketId;
+            preview.player = conversation.player;
+            if (!conversation.lines.empty())
+                preview.lastLine = conversation.lines.back().text;
+        }
+
+        size_t count = std::min(limit, matches.size());
+        std::partial_sort(matches.begin(), matches.begin() + count, matches.end(), [](OpenTicketPreview const& a, OpenTicketPreview const& b)
+        {
+            return a.ticketId > b.ticketId;
+        });
+        matches.resize(count);
+        return matches;
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_CONVERSATION_H
+#define MOD_GM_DISCORD_CONVERSATION_H
+
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace GMDiscord
+{
+    struct ConversationLine
+    {
+        uint64_t at = 0;
+        bool fromPlayer = false;
+        std::string author;
+        std::string text;
+    };
+
+    struct OpenTicketPreview
+    {
+        uint32_t ticketId = 0;
+        std::string player;
+        std::string lastLine;
+    };
+
+    // The last few whispers of every open ticket, both directions, kept in
+    // memory for the Details button and autocomplete. Each ticket holds at
+    // most `Lines` entries; past the global byte cap the oldest line of the
+    // least recently active ticket goes first. Fed from the world thread,
+    // read from DPP threads.
+    class ConversationBuffer
+    {
+    public:
+        static ConversationBuffer& Instance();
+
+        void LoadConfig();
+        // Startup: registers every open ticket so autocomplete sees them.
+        void Load();
+
+        void Open(uint32_t ticketId, std::string_view player);
+        void Close(uint32_t ticketId);
+        void Append(uint32_t ticketId, bool fromPlayer, std::string_view author, std::string_view text, uint64_t at);
+
+        std::vector<ConversationLine> GetLines(uint32_t ticketId) const;
+        // Open tickets whose id or player name starts with `prefix`, newest first.
+        std::vector<OpenTicketPreview> Find(std::string_view prefix, size_t limit) const;
+
+    private:
+        struct Conversation
+        {
+            std::string player;
+            std::deque<ConversationLine> lines;
+            // Position in _recent while the ticket has lines.
+            std::list<uint32_t>::iterator recent;
+            bool listed = false;
+        };
+
+        ConversationBuffer() = default;
+
+        static size_t GetLineBytes(ConversationLine const& line) { return sizeof(line) + line.author.size() + line.text.size(); }
+        void PopOldest(Conversation& conversation);
+
+        mutable std::mutex _mutex;
+        std::unordered_map<uint32_t, Conversation> _tickets;
+        // Least recently active first.
+        std::list<uint32_t> _recent;
+        size_t _bytes = 0;
+        size_t _maxLines = 20;
+        size_t _maxBytes = 2 * 1024 * 1024;
+    };
+}
+
+#endif
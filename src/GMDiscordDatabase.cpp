@@ -0,0 +1,106 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GMDiscordDatabase.h"
+
+#include "Config.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace GMDiscord
+{
+    namespace
+    {
+        static std::unique_ptr<ModuleDatabasePool> OpenPool(std::string const& info, uint8 asyncThreads, uint8 synchThreads,
+            char const* label)
+        {
+            auto pool = std::make_unique<ModuleDatabasePool>();
+            pool->SetConnectionInfo(info, asyncThreads, synchThreads);
+            if (pool->Open())
+            {
+                LOG_ERROR("module.gm_discord", "Cannot open the module {} database pool; using the core characters pool.", label);
+                return nullptr;
+            }
+
+            LOG_INFO("module.gm_discord", "Module {} database pool opened ({} async, {} synch connections).",
+                label, asyncThreads, synchThreads);
+            return pool;
+        }
+    }
+
+    ModuleDatabase& ModuleDatabase::Instance()
+    {
+        static ModuleDatabase instance;
+        return instance;
+    }
+
+    void ModuleDatabase::Open()
+    {
+        if (_pool || !sConfigMgr->GetOption<bool>("GMDiscord.Enable", true) ||
+            !sConfigMgr->GetOption<bool>("GMDiscord.Database.Enable", false))
+            return;
+
+        _drainMs = sConfigMgr->GetOption<uint32_t>("GMDiscord.Shutdown.DrainTimeoutMs", 5000);
+
+        std::string info = sConfigMgr->GetOption<std::string>("GMDiscord.Database.Info", "");
+        if (info.empty())
+            info = sConfigMgr->GetOption<std::string>("CharacterDatabaseInfo", "");
+
+        uint8 workers = static_cast<uint8>(std::clamp<uint32_t>(sConfigMgr->GetOption<uint32_t>("GMDiscord.Database.WorkerThreads", 1), 1, 8));
+        uint8 synch = static_cast<uint8>(std::clamp<uint32_t>(sConfigMgr->GetOption<uint32_t>("GMDiscord.Database.SynchThreads", 2), 1, 8));
+        _pool = OpenPool(info, workers, synch, "primary");
+        if (!_pool)
+            return;
+
+        std::string readInfo = sConfigMgr->GetOption<std::string>("GMDiscord.Database.ReadInfo", "");
+        if (!readInfo.empty())
+        {
+            // Lookups only; the one async worker just satisfies the pool.
+            uint8 readSynch = static_cast<uint8>(std::clamp<uint32_t>(sConfigMgr->GetOption<uint32_t>("GMDiscord.Database.ReadSynchThreads", 1), 1, 8));
+            _readPool = OpenPool(readInfo, 1, readSynch, "read");
+        }
+
+        _active.store(_pool.get(), std::memory_order_release);
+        _activeRead.store(_readPool.get(), std::memory_order_release);
+    }
+
+    void ModuleDatabase::Close()
+    {
+        ModuleDatabasePool* pool = _active.exchange(nullptr, std::memory_order_acq_rel);
+        ModuleDatabasePool* readPool = _activeRead.exchange(nullptr, std::memory_order_acq_rel);
+
+        if (readPool)
+            readPool->Close();
+
+        if (!pool)
+            return;
+
+        // Closing a pool drops whatever its async queue still holds.
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(_drainMs);
+        while (pool->QueueSize() && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        if (size_t left = pool->QueueSize())
+            LOG_WARN("module.gm_discord", "Module database pool closed with {} queued statements.", left);
+
+        pool->Close();
+    }
+}
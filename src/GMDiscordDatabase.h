@@ -0,0 +1,74 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_DATABASE_H
+#define MOD_GM_DISCORD_DATABASE_H
+
+#include "DatabaseEnv.h"
+
+#include <atomic>
+#include <memory>
+
+namespace GMDiscord
+{
+    using ModuleDatabasePool = DatabaseWorkerPool<CharacterDatabaseConnection>;
+
+    // Optional connection pools of the module's own, so outbox, audit and
+    // inbox traffic neither waits behind nor delays the core's character
+    // saves. While disabled (or before Open), both accessors return the core
+    // CharacterDatabase pool.
+    class ModuleDatabase
+    {
+    public:
+        static ModuleDatabase& Instance();
+
+        // Reads GMDiscord.Database.* and connects; pool sizes are fixed
+        // until restart. Falls back to the core pool when a connect fails.
+        void Open();
+        // Waits (bounded) for queued writes, then hands callers back to the
+        // core pool before closing. Call after the bot and spill queue stop.
+        void Close();
+
+        // Module tables, and anything that must see the module's own writes.
+        ModuleDatabasePool& Get() const
+        {
+            ModuleDatabasePool* pool = _active.load(std::memory_order_acquire);
+            return pool ? *pool : CharacterDatabase;
+        }
+
+        // Character lookups that tolerate replica lag.
+        ModuleDatabasePool& GetRead() const
+        {
+            ModuleDatabasePool* pool = _activeRead.load(std::memory_order_acquire);
+            return pool ? *pool : Get();
+        }
+
+    private:
+        ModuleDatabase() = default;
+
+        std::unique_ptr<ModuleDatabasePool> _pool;
+        std::unique_ptr<ModuleDatabasePool> _readPool;
+        std::atomic<ModuleDatabasePool*> _active{nullptr};
+        std::atomic<ModuleDatabasePool*> _activeRead{nullptr};
+        uint32_t _drainMs = 5000;
+    };
+
+    inline ModuleDatabasePool& ModuleDB() { return ModuleDatabase::Instance().Get(); }
+    inline ModuleDatabasePool& ModuleReadDB() { return ModuleDatabase::Instance().GetRead(); }
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GMDiscordEscalation.h"
+
+namespace GMDiscord
+{
+    EscalationTimers& EscalationTimers::Instance()
+    {
+        static EscalationTimers instance;
+        return instance;
+    }
+
+    void EscalationTimers::Arm(uint32_t ticketId, uint64_t deadline)
+    {
+        uint32_t generation = ++_generation;
+        _live[ticketId] = generation;
+        _heap.push({ deadline, ticketId, generation });
+
+        // Cancelled entries are only dropped when they reach the top; keep
+        // them from piling up when deadlines are long.
+        if (_heap.size() > 64 && _heap.size() > _live.size() * 4)
+            Compact();
+    }
+
+    void EscalationTimers::Cancel(uint32_t ticketId)
+    {
+        _live.erase(ticketId);
+    }
+
+    void EscalationTimers::Poll(uint64_t now, std::function<void(uint32_t)> const& fire)
+    {
+        while (!_heap.empty() && _heap.top().deadline <= now)
+        {
+            Entry entry = _heap.top();
+            _heap.pop();
+
+            auto it = _live.find(entry.ticketId);
+            if (it == _live.end() || it->second != entry.generation)
+                continue;
+
+            _live.erase(it);
+            fire(entry.ticketId);
+        }
+    }
+
+    void EscalationTimers::Compact()
+    {
+        std::vector<Entry> kept;
+        kept.reserve(_live.size());
+        while (!_heap.empty())
+        {
+            Entry const& entry = _heap.top();
+            auto it = _live.find(entry.ticketId);
+            if (it != _live.end() && it->second == entry.generation)
+                kept.push_back(entry);
+            _heap.pop();
+        }
+
+        _heap = decltype(_heap)(std::greater<Entry>(), std::move(kept));
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_ESCALATION_H
+#define MOD_GM_DISCORD_ESCALATION_H
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace GMDiscord
+{
+    // Per-ticket response deadlines. Deadlines live in a min-heap; the live
+    // generation per ticket sits in a hash map, so cancelling is an O(1)
+    // erase and stale heap entries are discarded when they surface. A tick
+    // with nothing due is a single comparison against the heap top.
+    // World thread only.
+    class EscalationTimers
+    {
+    public:
+        static EscalationTimers& Instance();
+
+        // Re-arming replaces the ticket's previous deadline.
+        void Arm(uint32_t ticketId, uint64_t deadline);
+        void Cancel(uint32_t ticketId);
+
+        // Invokes `fire` for every ticket whose deadline is <= now.
+        void Poll(uint64_t now, std::function<void(uint32_t)> const& fire);
+
+        size_t GetArmedCount() const { return _live.size(); }
+
+    private:
+        struct Entry
+        {
+            uint64_t deadline;
+            uint32_t ticketId;
+            uint32_t generation;
+
+            bool operator>(Entry const& other) const { return deadline > other.deadline; }
+        };
+
+        EscalationTimers() = default;
+
+        void Compact();
+
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> _heap;
+        std::unordered_map<uint32_t, uint32_t> _live;
+        uint32_t _generation = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,221 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_FLAT_MAP_H
+#define MOD_GM_DISCORD_FLAT_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace GMDiscord
+{
+    // Read-mostly table keyed by snowflakes or other ids, built once and
+    // published (role mappings, the presence directory). Keys and values
+    // live in two contiguous arrays; Find is a branchless binary search
+    // over the keys, so a lookup touches a few cache lines and no nodes.
+    template <typename V>
+    class SortedIdTable
+    {
+    public:
+        SortedIdTable() = default;
+
+        // Duplicate keys keep the last value.
+        explicit SortedIdTable(std::vector<std::pair<uint64_t, V>> entries)
+        {
+            std::stable_sort(entries.begin(), entries.end(), [](auto const& a, auto const& b) { return a.first < b.first; });
+            _keys.reserve(entries.size());
+            _values.reserve(entries.size());
+            for (auto& [key, value] : entries)
+            {
+                if (!_keys.empty() && _keys.back() == key)
+                {
+                    _values.back() = std::move(value);
+                    continue;
+                }
+                _keys.push_back(key);
+                _values.push_back(std::move(value));
+            }
+        }
+
+        V const* Find(uint64_t key) const
+        {
+            if (_keys.empty())
+                return nullptr;
+
+            uint64_t const* base = _keys.data();
+            size_t length = _keys.size();
+            while (length > 1)
+            {
+                size_t half = length / 2;
+                // Compiles to a conditional move, not a branch.
+                base += (base[half] <= key) ? half : 0;
+                length -= half;
+            }
+            return *base == key ? &_values[base - _keys.data()] : nullptr;
+        }
+
+        bool empty() const { return _keys.empty(); }
+        size_t size() const { return _keys.size(); }
+        std::vector<uint64_t> const& Keys() const { return _keys; }
+        std::vector<V> const& Values() const { return _values; }
+
+    private:
+        std::vector<uint64_t> _keys;
+        std::vector<V> _values;
+    };
+
+    // Mutable id-keyed map with open addressing and linear probing: keys
+    // and values sit in flat arrays, erase shifts the following run back
+    // instead of leaving tombstones. Key 0 marks a free slot, so it can't
+    // be stored (ticket ids and snowflakes are never 0). Not thread-safe.
+    template <typename V>
+    class FlatIdMap
+    {
+    public:
+        V* Find(uint64_t key)
+        {
+            size_t slot = FindSlot(key);
+            return slot != NOT_FOUND ? &_values[slot] : nullptr;
+        }
+
+        V const* Find(uint64_t key) const
+        {
+            size_t slot = FindSlot(key);
+            return slot != NOT_FOUND ? &_values[slot] : nullptr;
+        }
+
+        // Value for `key`, default-constructed if it was absent (`inserted`).
+        V& Emplace(uint64_t key, bool& inserted)
+        {
+            if ((_size + 1) * 4 > _keys.size() * 3)
+                Rehash(_keys.empty() ? 16 : _keys.size() * 2);
+
+            size_t mask = _keys.size() - 1;
+            for (size_t slot = Hash(key) & mask;; slot = (slot + 1) & mask)
+            {
+                if (_keys[slot] == key)
+                {
+                    inserted = false;
+                    return _values[slot];
+                }
+                if (!_keys[slot])
+                {
+                    _keys[slot] = key;
+                    ++_size;
+                    inserted = true;
+                    return _values[slot];
+                }
+            }
+        }
+
+        V& operator[](uint64_t key)
+        {
+            bool inserted;
+            return Emplace(key, inserted);
+        }
+
+        bool Erase(uint64_t key)
+        {
+            size_t slot = FindSlot(key);
+            if (slot == NOT_FOUND)
+                return false;
+
+            // Backward shift: pull later entries of the probe run into the
+            // hole unless that would move them before their home slot.
+            size_t mask = _keys.size() - 1;
+            size_t hole = slot;
+            for (size_t next = (hole + 1) & mask; _keys[next]; next = (next + 1) & mask)
+            {
+                size_t home = Hash(_keys[next]) & mask;
+                if (((next - home) & mask) >= ((next - hole) & mask))
+                {
+                    _keys[hole] = _keys[next];
+                    _values[hole] = std::move(_values[next]);
+                    hole = next;
+                }
+            }
+            _keys[hole] = 0;
+            _values[hole] = V();
+            --_size;
+            return true;
+        }
+
+        void Clear()
+        {
+            _keys.clear();
+            _values.clear();
+            _size = 0;
+        }
+
+        size_t size() const { return _size; }
+        bool empty() const { return !_size; }
+
+        template <typename Fn>
+        void ForEach(Fn&& fn) const
+        {
+            for (size_t slot = 0; slot < _keys.size(); ++slot)
+                if (_keys[slot])
+                    fn(_keys[slot], _values[slot]);
+        }
+
+    private:
+        static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+        static size_t Hash(uint64_t key)
+        {
+            // Fibonacci hashing spreads sequential ids and snowflakes.
+            return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32);
+        }
+
+        size_t FindSlot(uint64_t key) const
+        {
+            if (!_size || !key)
+                return NOT_FOUND;
+
+            size_t mask = _keys.size() - 1;
+            for (size_t slot = Hash(key) & mask; _keys[slot]; slot = (slot + 1) & mask)
+                if (_keys[slot] == key)
+                    return slot;
+            return NOT_FOUND;
+        }
+
+        void Rehash(size_t capacity)
+        {
+            std::vector<uint64_t> keys(capacity, 0);
+            std::vector<V> values(capacity);
+            std::swap(keys, _keys);
+            std::swap(values, _values);
+            _size = 0;
+            for (size_t slot = 0; slot < keys.size(); ++slot)
+            {
+                if (!keys[slot])
+                    continue;
+                bool inserted;
+                Emplace(keys[slot], inserted) = std::move(values[slot]);
+            }
+        }
+
+        std::vector<uint64_t> _keys;
+        std::vector<V> _values;
+        size_t _size = 0;
+    };
+}
+
+#endif
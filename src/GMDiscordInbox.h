@@ -0,0 +1,73 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_INBOX_H
+#define MOD_GM_DISCORD_INBOX_H
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+namespace GMDiscord
+{
+    // Scheduling lane stored with every inbox row. The world thread serves
+    // lanes with weighted fair scheduling so a flood of bulk commands can't
+    // hold back whispers, ticket actions or account linking.
+    enum InboxLane : uint8_t
+    {
+        INBOX_LANE_INTERACTIVE = 0,
+        INBOX_LANE_AUTH        = 1,
+        INBOX_LANE_BULK        = 2,
+        MAX_INBOX_LANES
+    };
+
+    inline InboxLane GetInboxLane(std::string_view action)
+    {
+        if (action == "auth")
+            return INBOX_LANE_AUTH;
+        if (action == "command")
+            return INBOX_LANE_BULK;
+        return INBOX_LANE_INTERACTIVE;
+    }
+
+    // Raised by the bot whenever it queues an inbox row so the world thread
+    // can drop to its fast poll interval instead of waiting out a backoff.
+    inline std::atomic_bool g_InboxActivity{false};
+
+    inline void SignalInboxActivity()
+    {
+        g_InboxActivity.store(true, std::memory_order_release);
+    }
+
+    inline bool ConsumeInboxActivity()
+    {
+        return g_InboxActivity.load(std::memory_order_relaxed) && g_InboxActivity.exchange(false, std::memory_order_acq_rel);
+    }
+
+    inline char const* GetInboxLaneName(uint8_t lane)
+    {
+        switch (lane)
+        {
+            case INBOX_LANE_INTERACTIVE: return "interactive";
+            case INBOX_LANE_AUTH: return "auth";
+            case INBOX_LANE_BULK: return "bulk";
+            default: return "unknown";
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,247 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GMDiscordKeywords.h"
+
+#include "Config.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+
+namespace GMDiscord
+{
+    namespace
+    {
+        constexpr uint32_t NO_STATE = UINT32_MAX;
+
+        static std::string_view TrimView(std::string_view value)
+        {
+            while (!value.empty() && std::isspace(static_cast<unsigned char>(value.front())))
+                value.remove_prefix(1);
+            while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back())))
+                value.remove_suffix(1);
+            return value;
+        }
+
+        static std::string ToLower(std::string_view value)
+        {
+            std::string out(value);
+            std::transform(out.begin(), out.end(), out.begin(), [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+            return out;
+        }
+
+        static void AddPattern(std::vector<std::pair<std::string, std::string>>& patterns, std::string_view category, std::string_view pattern)
+        {
+            category = TrimView(category);
+            pattern = TrimView(pattern);
+            if (!category.empty() && !pattern.empty())
+                patterns.emplace_back(ToLower(category), ToLower(pattern));
+        }
+    }
+
+    KeywordMatcher& KeywordMatcher::Instance()
+    {
+        static KeywordMatcher instance;
+        return instance;
+    }
+
+    void KeywordMatcher::LoadConfig()
+    {
+        std::string inlinePatterns = sConfigMgr->GetOption<std::string>("GMDiscord.Keywords.Patterns", "", false);
+        std::string file = sConfigMgr->GetOption<std::string>("GMDiscord.Keywords.File", "", false);
+
+        std::string source = inlinePatterns;
+        if (!file.empty())
+        {
+            std::ifstream in(file);
+            if (!in)
+                LOG_ERROR("module.gm_discord", "Cannot read keyword file {}.", file);
+            else
+            {
+                std::ostringstream contents;
+                contents << in.rdbuf();
+                source += '\n';
+                source += contents.str();
+            }
+        }
+
+        // Reloads keep the current automaton unless the patterns changed.
+        if (source == _automaton.Get().source)
+            return;
+
+        std::vector<std::pair<std::string, std::string>> patterns;
+        std::string_view rest(inlinePatterns);
+        while (!rest.empty())
+        {
+            size_t end = rest.find(';');
+            std::string_view entry = rest.substr(0, end);
+            rest = end == std::string_view::npos ? std::string_view() : rest.substr(end + 1);
+
+            size_t sep = entry.find(':');
+            if (sep == std::string_view::npos)
+                continue;
+
+            std::string_view list = entry.substr(sep + 1);
+            while (!list.empty())
+            {
+                size_t comma = list.find(',');
+                AddPattern(patterns, entry.substr(0, sep), list.substr(0, comma));
+                list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+            }
+        }
+
+        std::string_view fileText = std::string_view(source).substr(inlinePatterns.size());
+        while (!fileText.empty())
+        {
+            size_t end = fileText.find('\n');
+            std::string_view line = TrimView(fileText.substr(0, end));
+            fileText = end == std::string_view::npos ? std::string_view() : fileText.substr(end + 1);
+
+            size_t sep = line.find(':');
+            if (line.empty() || line.front() == '#' || sep == std::string_view::npos)
+                continue;
+            AddPattern(patterns, line.substr(0, sep), line.substr(sep + 1));
+        }
+
+        auto automaton = std::make_unique<Automaton>();
+        automaton->source = std::move(source);
+        Build(*automaton, patterns);
+        if (!patterns.empty())
+            LOG_INFO("module.gm_discord", "Compiled {} keyword patterns in {} categories ({} states).",
+                patterns.size(), automaton->categories.size(), automaton->output.size());
+        _automaton.Publish(std::move(automaton));
+    }
+
+    void KeywordMatcher::Build(Automaton& automaton, std::vector<std::pair<std::string, std::string>> const& patterns)
+    {
+        // Byte classes keep the transition table narrow: one column per
+        // distinct pattern byte, upper case folded onto lower case.
+        for (auto const& [category, pattern] : patterns)
+            for (unsigned char ch : pattern)
+                if (!automaton.byteClass[ch])
+                {
+                    if (automaton.classCount > UINT8_MAX)
+                        break;
+                    automaton.byteClass[ch] = static_cast<uint8_t>(automaton.classCount++);
+                }
+        for (int ch = 'A'; ch <= 'Z'; ++ch)
+            automaton.byteClass[ch] = automaton.byteClass[std::tolower(ch)];
+
+        uint32_t const width = automaton.classCount;
+        automaton.next.assign(width, NO_STATE);
+        automaton.output.assign(1, 0);
+
+        for (auto const& [category, pattern] : patterns)
+        {
+            auto categoryIt = std::find(automaton.categories.begin(), automaton.categories.end(), category);
+            if (categoryIt == automaton.categories.end())
+            {
+                if (automaton.categories.size() == MAX_CATEGORIES)
+                {
+                    LOG_ERROR("module.gm_discord", "Keyword category {} ignored: at most {} categories.", category, MAX_CATEGORIES);
+                    continue;
+                }
+                categoryIt = automaton.categories.insert(automaton.categories.end(), category);
+            }
+
+            uint32_t state = 0;
+            for (unsigned char ch : pattern)
+            {
+                uint32_t& target = automaton.next[state * width + automaton.byteClass[ch]];
+                if (target == NO_STATE)
+                {
+                    target = static_cast<uint32_t>(automaton.output.size());
+                    automaton.output.push_back(0);
+                    automaton.next.resize(automaton.next.size() + width, NO_STATE);
+                }
+                state = automaton.next[state * width + automaton.byteClass[ch]];
+            }
+            automaton.output[state] |= 1u << std::distance(automaton.categories.begin(), categoryIt);
+        }
+
+        // Breadth-first: fill every missing transition from the failure
+        // state, so scanning never has to follow failure links.
+        std::vector<uint32_t> fail(automaton.output.size(), 0);
+        std::vector<uint32_t> queue;
+        queue.reserve(automaton.output.size());
+        for (uint32_t cls = 0; cls < width; ++cls)
+        {
+            uint32_t& target = automaton.next[cls];
+            if (target == NO_STATE)
+                target = 0;
+            else
+                queue.push_back(target);
+        }
+
+        for (size_t head = 0; head < queue.size(); ++head)
+        {
+            uint32_t state = queue[head];
+            automaton.output[state] |= automaton.output[fail[state]];
+            for (uint32_t cls = 0; cls < width; ++cls)
+            {
+                uint32_t& target = automaton.next[state * width + cls];
+                uint32_t fallback = automaton.next[fail[state] * width + cls];
+                if (target == NO_STATE)
+                    target = fallback;
+                else
+                {
+                    fail[target] = fallback;
+                    queue.push_back(target);
+                }
+            }
+        }
+    }
+
+    uint32_t KeywordMatcher::Scan(std::string_view text) const
+    {
+        Automaton const& automaton = _automaton.Get();
+        if (automaton.categories.empty())
+            return 0;
+
+        uint32_t const* next = automaton.next.data();
+        uint32_t const* output = automaton.output.data();
+        uint32_t const width = automaton.classCount;
+        uint32_t state = 0;
+        uint32_t mask = 0;
+        for (unsigned char ch : text)
+        {
+            state = next[state * width + automaton.byteClass[ch]];
+            mask |= output[state];
+        }
+        return mask;
+    }
+
+    std::string KeywordMatcher::FormatCategories(uint32_t mask) const
+    {
+        Automaton const& automaton = _automaton.Get();
+        std::string out;
+        for (size_t i = 0; i < automaton.categories.size(); ++i)
+        {
+            if (!(mask & (1u << i)))
+                continue;
+            if (!out.empty())
+                out += ',';
+            out += automaton.categories[i];
+        }
+        return out;
+    }
+}
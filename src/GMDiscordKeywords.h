@@ -0,0 +1,79 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_KEYWORDS_H
+#define MOD_GM_DISCORD_KEYWORDS_H
+
+#include "GMDiscordSettings.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace GMDiscord
+{
+    // Flags player text (whispers, tickets) that contains any configured
+    // pattern. All patterns are compiled into one Aho-Corasick automaton
+    // with precomputed transitions, so a scan is a single pass with one
+    // table lookup per byte however many patterns there are. Matching is
+    // ASCII case-insensitive and finds patterns anywhere in the text.
+    //
+    // Patterns come from GMDiscord.Keywords.Patterns
+    // ("category:pattern,pattern;category:pattern") and, for long lists,
+    // GMDiscord.Keywords.File (one "category:pattern" per line).
+    class KeywordMatcher
+    {
+    public:
+        // Each category is one bit of a scan result.
+        static constexpr size_t MAX_CATEGORIES = 32;
+
+        static KeywordMatcher& Instance();
+
+        void LoadConfig();
+
+        // Bitmask of the categories matched in `text`; 0 when none.
+        uint32_t Scan(std::string_view text) const;
+
+        // "spam,scam" for a Scan() result.
+        std::string FormatCategories(uint32_t mask) const;
+
+    private:
+        struct Automaton
+        {
+            // Bytes that occur in no pattern share class 0.
+            std::array<uint8_t, 256> byteClass{ };
+            uint32_t classCount = 1;
+            // Row per state, column per byte class.
+            std::vector<uint32_t> next;
+            // Categories ending at each state, including shorter suffixes.
+            std::vector<uint32_t> output;
+            std::vector<std::string> categories;
+            // Pattern source the automaton was built from.
+            std::string source;
+        };
+
+        KeywordMatcher() = default;
+
+        static void Build(Automaton& automaton, std::vector<std::pair<std::string, std::string>> const& patterns);
+
+        SettingsSnapshot<Automaton> _automaton;
+    };
+}
+
+#endif
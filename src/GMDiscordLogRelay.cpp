@@ -0,0 +1,240 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GMDiscordLogRelay.h"
+
+#include "Appender.h"
+#include "Config.h"
+#include "Log.h"
+#include "LogMessage.h"
+#include "StringFormat.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace GMDiscord
+{
+    namespace
+    {
+        constexpr char const* RELAY_APPENDER_NAME = "GMDiscord";
+
+        char const* GetLevelName(uint8_t level)
+        {
+            switch (level)
+            {
+                case LOG_LEVEL_FATAL: return "FATAL";
+                case LOG_LEVEL_ERROR: return "ERROR";
+                case LOG_LEVEL_WARN: return "WARN";
+                case LOG_LEVEL_INFO: return "INFO";
+                default: return "DEBUG";
+            }
+        }
+
+        // Created by the module as `Appender.GMDiscord=5,<level>,0`; the level
+        // decides what reaches Discord, the loggers listing it the categories.
+        class DiscordLogAppender : public Appender
+        {
+        public:
+            static constexpr AppenderType type = AppenderType(5);
+
+            DiscordLogAppender(uint8 id, std::string const& name, LogLevel level, AppenderFlags flags, std::vector<std::string_view> const& /*extraArgs*/)
+                : Appender(id, name, level, flags) { }
+
+            AppenderType getType() const override { return type; }
+
+        private:
+            void _write(LogMessage const* message) override
+            {
+                LogRelay::Instance().Push(message->level, message->type, message->text, message->mtime);
+            }
+        };
+    }
+
+    LogRelay& LogRelay::Instance()
+    {
+        static LogRelay instance;
+        return instance;
+    }
+
+    LogRelay::LogRelay()
+    {
+        for (size_t i = 0; i < CAPACITY; ++i)
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    void LogRelay::Push(uint8_t level, std::string_view category, std::string_view text, time_t at)
+    {
+        if (!_enabled.load(std::memory_order_relaxed))
+            return;
+
+        uint64_t offered = _offered.fetch_add(1, std::memory_order_relaxed);
+        size_t fill = _enqueue.load(std::memory_order_relaxed) - _dequeue.load(std::memory_order_relaxed);
+        if (fill > CAPACITY / 2 && offered % SAMPLE_STRIDE)
+        {
+            _sampledOut.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        size_t position = _enqueue.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;)
+        {
+            slot = &_slots[position % CAPACITY];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (diff == 0)
+            {
+                if (_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            else
+                position = _enqueue.load(std::memory_order_relaxed);
+        }
+
+        slot->at = at;
+        slot->level = level;
+        slot->categoryLength = static_cast<uint8_t>(std::min(category.size(), MAX_CATEGORY));
+        slot->textLength = static_cast<uint16_t>(std::min(text.size(), MAX_TEXT));
+        std::memcpy(slot->category, category.data(), slot->categoryLength);
+        std::memcpy(slot->text, text.data(), slot->textLength);
+        slot->sequence.store(position + 1, std::memory_order_release);
+    }
+
+    bool LogRelay::Pop(Pending& line)
+    {
+        size_t position = _dequeue.load(std::memory_order_relaxed);
+        Slot& slot = _slots[position % CAPACITY];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+            return false;
+
+        line.first = slot.at;
+        line.level = slot.level;
+        line.count = 1;
+        line.category.assign(slot.category, slot.categoryLength);
+        line.text.assign(slot.text, slot.textLength);
+        // Backticks would close the code block.
+        std::replace(line.text.begin(), line.text.end(), '`', '\'');
+
+        slot.sequence.store(position + CAPACITY, std::memory_order_release);
+        _dequeue.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    std::string LogRelay::TakeBatch(size_t maxChars)
+    {
+        Pending line;
+        while (Pop(line))
+        {
+            std::string key = line.category + '\0' + line.text;
+            auto it = _pendingIndex.find(key);
+            if (it != _pendingIndex.end())
+                ++_pending[it->second].count;
+            else if (_pending.size() < MAX_PENDING)
+            {
+                _pendingIndex.emplace(std::move(key), _pending.size());
+                _pending.push_back(std::move(line));
+            }
+            else
+                ++_overflow;
+        }
+
+        uint64_t dropped = _dropped.load(std::memory_order_relaxed);
+        uint64_t sampledOut = _sampledOut.load(std::memory_order_relaxed);
+        std::string footer;
+        if (dropped != _reportedDropped || sampledOut != _reportedSampledOut || _overflow)
+            footer = Acore::StringFormat("... {} dropped, {} sampled out\n",
+                dropped - _reportedDropped + _overflow, sampledOut - _reportedSampledOut);
+
+        if (_pending.empty() && footer.empty())
+            return {};
+
+        std::string body = "```\n";
+        size_t taken = 0;
+        for (; taken < _pending.size(); ++taken)
+        {
+            Pending const& pending = _pending[taken];
+            uint32_t secondOfDay = static_cast<uint32_t>(pending.first % 86400);
+            std::string entry = Acore::StringFormat("{:02}:{:02}:{:02}Z {} {}: {}", secondOfDay / 3600, secondOfDay / 60 % 60, secondOfDay % 60,
+                GetLevelName(pending.level), pending.category, pending.text);
+            if (pending.count > 1)
+                entry += Acore::StringFormat(" (x{})", pending.count);
+            entry += '\n';
+
+            // Always take one line so an oversized one can't stall the relay.
+            if (taken && body.size() + entry.size() + footer.size() + 3 > maxChars)
+                break;
+            body += entry.substr(0, maxChars - footer.size() - 8);
+        }
+
+        body += footer;
+        body += "```";
+
+        _pending.erase(_pending.begin(), _pending.begin() + taken);
+        _pendingIndex.clear();
+        for (size_t i = 0; i < _pending.size(); ++i)
+            _pendingIndex.emplace(_pending[i].category + '\0' + _pending[i].text, i);
+
+        _reportedDropped = dropped;
+        _reportedSampledOut = sampledOut;
+        _overflow = 0;
+        return body;
+    }
+
+    void RegisterDiscordLogAppender()
+    {
+        sLog->RegisterAppender<DiscordLogAppender>();
+
+        // The core parsed its log config before modules load. Reloading it
+        // would reopen (and truncate) every file appender, so only this
+        // module's appender and loggers are created here.
+        uint32 level = sConfigMgr->GetOption<uint32>("GMDiscord.Bot.LogRelay.Level", LOG_LEVEL_ERROR);
+        sLog->CreateAppenderFromConfigLine(Acore::StringFormat("Appender.{}", RELAY_APPENDER_NAME),
+            Acore::StringFormat("{},{},0", uint32(DiscordLogAppender::type), level));
+
+        // "category=level,appenders;..." -> Logger.<category>=level,appenders GMDiscord
+        std::string loggers = sConfigMgr->GetOption<std::string>("GMDiscord.Bot.LogRelay.Loggers", "");
+        size_t start = 0;
+        while (start <= loggers.size())
+        {
+            size_t end = loggers.find(';', start);
+            if (end == std::string::npos)
+                end = loggers.size();
+
+            std::string entry = loggers.substr(start, end - start);
+            start = end + 1;
+
+            size_t eq = entry.find('=');
+            if (eq == std::string::npos)
+                continue;
+
+            std::string category = entry.substr(0, eq);
+            std::string options = entry.substr(eq + 1);
+            category.erase(std::remove(category.begin(), category.end(), ' '), category.end());
+            if (category.empty() || options.empty())
+                continue;
+
+            if (options.find(',') == std::string::npos)
+                options += ",";
+            sLog->CreateLoggerFromConfigLine("Logger." + category, Acore::StringFormat("{} {}", options, RELAY_APPENDER_NAME));
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_LOG_RELAY_H
+#define MOD_GM_DISCORD_LOG_RELAY_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace GMDiscord
+{
+    // Carries worldserver log lines from the Discord appender to the bot.
+    // Producers (any logging thread) write into a bounded ring with one
+    // sequence number per slot and never wait: a full ring drops the line,
+    // and past half full only every SAMPLE_STRIDE-th line is kept. The bot
+    // timer is the only consumer; it folds identical lines into one with a
+    // count and renders one code-block message per tick.
+    class LogRelay
+    {
+    public:
+        static LogRelay& Instance();
+
+        // Off until the bot has a channel to send to; Push is then a no-op.
+        void SetEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+
+        void Push(uint8_t level, std::string_view category, std::string_view text, time_t at);
+
+        // Consumer only. Message body of at most `maxChars`, or empty when
+        // nothing is waiting. Lines that don't fit wait for the next call.
+        std::string TakeBatch(size_t maxChars);
+
+    private:
+        static constexpr size_t CAPACITY = 512;
+        static constexpr size_t SAMPLE_STRIDE = 8;
+        static constexpr size_t MAX_CATEGORY = 47;
+        static constexpr size_t MAX_TEXT = 383;
+        static constexpr size_t MAX_PENDING = 256;
+
+        struct Slot
+        {
+            std::atomic<size_t> sequence{0};
+            time_t at = 0;
+            uint8_t level = 0;
+            uint8_t categoryLength = 0;
+            uint16_t textLength = 0;
+            char category[MAX_CATEGORY];
+            char text[MAX_TEXT];
+        };
+
+        struct Pending
+        {
+            time_t first = 0;
+            uint8_t level = 0;
+            uint32_t count = 0;
+            std::string category;
+            std::string text;
+        };
+
+        LogRelay();
+
+        bool Pop(Pending& line);
+
+        std::atomic_bool _enabled{false};
+        std::array<Slot, CAPACITY> _slots;
+        alignas(64) std::atomic<size_t> _enqueue{0};
+        alignas(64) std::atomic<size_t> _dequeue{0};
+        std::atomic<uint64_t> _offered{0};
+        std::atomic<uint64_t> _dropped{0};
+        std::atomic<uint64_t> _sampledOut{0};
+
+        // Consumer only.
+        std::vector<Pending> _pending;
+        std::unordered_map<std::string, size_t> _pendingIndex;
+        uint64_t _overflow = 0;
+        uint64_t _reportedDropped = 0;
+        uint64_t _reportedSampledOut = 0;
+    };
+
+    // Registers the relay appender type and creates only the module's own
+    // GMDiscord appender plus the loggers listed in
+    // GMDiscord.Bot.LogRelay.Loggers; the core log config is left alone.
+    void RegisterDiscordLogAppender();
+}
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GMDiscordMetrics.h"
+
+namespace GMDiscord
+{
+    Metrics& Metrics::Instance()
+    {
+        static Metrics instance;
+        return instance;
+    }
+
+    std::atomic<uint64_t>& Metrics::Get(std::string const& name)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _values.try_emplace(name, 0).first->second;
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> Metrics::Snapshot() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<std::pair<std::string, uint64_t>> values;
+        values.reserve(_values.size());
+        for (auto const& [name, value] : _values)
+            values.emplace_back(name, value.load(std::memory_order_relaxed));
+        return values;
+    }
+}
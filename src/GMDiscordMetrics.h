@@ -0,0 +1,51 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_METRICS_H
+#define MOD_GM_DISCORD_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace GMDiscord
+{
+    // Process-wide named counters and gauges shown by `/gm-stats`. Look a
+    // metric up once and keep the reference: entries are never removed and
+    // map nodes don't move, so updates are a single relaxed atomic op.
+    class Metrics
+    {
+    public:
+        static Metrics& Instance();
+
+        std::atomic<uint64_t>& Get(std::string const& name);
+
+        std::vector<std::pair<std::string, uint64_t>> Snapshot() const;
+
+    private:
+        Metrics() = default;
+
+        mutable std::mutex _mutex;
+        std::map<std::string, std::atomic<uint64_t>> _values;
+    };
+}
+
+#endif
@@ -0,0 +1,235 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GMDiscordPresence.h"
+#include "GMDiscordDatabase.h"
+
+#include "Config.h"
+#include "DatabaseEnv.h"
+#include "Log.h"
+#include "Player.h"
+#include "WorldSessionMgr.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace GMDiscord
+{
+    namespace
+    {
+        int64_t NowSeconds()
+        {
+            return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    GmPresence& GmPresence::Instance()
+    {
+        static GmPresence instance;
+        return instance;
+    }
+
+    void GmPresence::LoadConfig()
+    {
+        // The window used to be auto-assign only; keep honouring its old key.
+        uint32 legacy = sConfigMgr->GetOption<uint32>("GMDiscord.AutoAssign.PresenceWindowSeconds", 900, false);
+        _activityWindow = sConfigMgr->GetOption<uint32>("GMDiscord.Presence.ActivityWindowSeconds", legacy);
+    }
+
+    void GmPresence::Load()
+    {
+        QueryResult result = ModuleDB().Query(
+            "SELECT account_id, discord_user_id, gm_name FROM gm_discord_link WHERE verified=1");
+        if (!result)
+            return;
+
+        do
+        {
+            Field* fields = result->Fetch();
+            Register(fields[0].Get<uint32>(), fields[1].Get<uint64>(), fields[2].Get<std::string>());
+        } while (result->NextRow());
+
+        LOG_INFO("module.gm_discord", "Presence tracking {} linked GM accounts.", GetAll().size());
+    }
+
+    void GmPresence::Register(uint32_t accountId, uint64_t discordUserId, std::string const& gmName)
+    {
+        std::lock_guard<std::mutex> lock(_writeMutex);
+        Slot*& slot = _slotByAccount[accountId];
+        if (!slot)
+        {
+            slot = &_slots.emplace_back();
+            slot->accountId = accountId;
+        }
+
+        auto it = _live.find(accountId);
+        if (it == _live.end())
+        {
+            // New, or re-linked after an unlink: nothing tracked it meanwhile.
+            WorldSession* session = sWorldSessionMgr->FindSession(accountId);
+            slot->inGame = session && session->GetPlayer() != nullptr;
+            slot->discordOnline = false;
+            slot->hasTicketRole = false;
+            slot->lastInteraction = 0;
+        }
+        else if (it->second.discordUserId != discordUserId)
+        {
+            // Discord state belonged to the previous user.
+            slot->discordOnline = false;
+            slot->hasTicketRole = false;
+            slot->lastInteraction = 0;
+        }
+
+        _live[accountId] = { discordUserId, gmName };
+        PublishLocked();
+    }
+
+    void GmPresence::Unregister(uint32_t accountId)
+    {
+        std::lock_guard<std::mutex> lock(_writeMutex);
+        if (_live.erase(accountId))
+            PublishLocked();
+    }
+
+    void GmPresence::PublishLocked()
+    {
+        std::vector<std::pair<uint64_t, Member>> byAccount;
+        std::vector<std::pair<uint64_t, Slot*>> byDiscordUser;
+        for (auto const& [accountId, identity] : _live)
+        {
+            Slot* slot = _slotByAccount[accountId];
+            byAccount.emplace_back(accountId, Member{ slot, identity });
+            if (identity.discordUserId)
+                byDiscordUser.emplace_back(identity.discordUserId, slot);
+        }
+
+        auto directory = std::make_unique<Directory>();
+        directory->byAccount = SortedIdTable<Member>(std::move(byAccount));
+        directory->byDiscordUser = SortedIdTable<Slot*>(std::move(byDiscordUser));
+        _directory.Publish(std::move(directory));
+    }
+
+    void GmPresence::SetInGame(uint32_t accountId, bool inGame)
+    {
+        if (Slot* slot = FindAccount(accountId))
+            slot->inGame.store(inGame, std::memory_order_relaxed);
+    }
+
+    uint32_t GmPresence::SetDiscordStatus(uint64_t discordUserId, bool online)
+    {
+        Slot* slot = FindDiscordUser(discordUserId);
+        if (!slot)
+            return 0;
+
+        slot->discordOnline.store(online, std::memory_order_relaxed);
+        return slot->accountId;
+    }
+
+    void GmPresence::SetTicketRole(uint64_t discordUserId, bool hasTicketRole)
+    {
+        if (Slot* slot = FindDiscordUser(discordUserId))
+            slot->hasTicketRole.store(hasTicketRole, std::memory_order_relaxed);
+    }
+
+    uint32_t GmPresence::OnDiscordInteraction(uint64_t discordUserId, bool hasTicketRole)
+    {
+        Slot* slot = FindDiscordUser(discordUserId);
+        if (!slot)
+            return 0;
+
+        slot->hasTicketRole.store(hasTicketRole, std::memory_order_relaxed);
+        slot->lastInteraction.store(NowSeconds(), std::memory_order_relaxed);
+        return slot->accountId;
+    }
+
+    bool GmPresence::IsInGame(uint32_t accountId) const
+    {
+        Slot* slot = FindAccount(accountId);
+        return slot && slot->inGame.load(std::memory_order_relaxed);
+    }
+
+    bool GmPresence::IsOnDiscord(uint32_t accountId) const
+    {
+        Slot* slot = FindAccount(accountId);
+        return slot && IsOnDiscord(*slot, NowSeconds());
+    }
+
+    bool GmPresence::IsReachable(uint32_t accountId) const
+    {
+        Slot* slot = FindAccount(accountId);
+        if (!slot)
+            return false;
+        if (slot->inGame.load(std::memory_order_relaxed))
+            return true;
+        return slot->hasTicketRole.load(std::memory_order_relaxed) && IsOnDiscord(*slot, NowSeconds());
+    }
+
+    std::vector<GmPresenceInfo> GmPresence::GetAll() const
+    {
+        std::vector<GmPresenceInfo> all;
+        int64_t now = NowSeconds();
+        SortedIdTable<Member> const& byAccount = _directory.Get().byAccount;
+        for (size_t i = 0; i < byAccount.size(); ++i)
+        {
+            Member const& member = byAccount.Values()[i];
+            Slot const* slot = member.slot;
+            GmPresenceInfo& info = all.emplace_back();
+            info.accountId = static_cast<uint32_t>(byAccount.Keys()[i]);
+            info.discordUserId = member.identity.discordUserId;
+            info.gmName = member.identity.gmName;
+            info.inGame = slot->inGame.load(std::memory_order_relaxed);
+            info.onDiscord = IsOnDiscord(*slot, now);
+        }
+
+        std::sort(all.begin(), all.end(), [](GmPresenceInfo const& a, GmPresenceInfo const& b) { return a.gmName < b.gmName; });
+        return all;
+    }
+
+    std::vector<uint64_t> GmPresence::GetDiscordReachable() const
+    {
+        std::vector<uint64_t> users;
+        int64_t now = NowSeconds();
+        SortedIdTable<Slot*> const& byDiscordUser = _directory.Get().byDiscordUser;
+        for (size_t i = 0; i < byDiscordUser.size(); ++i)
+        {
+            Slot const* slot = byDiscordUser.Values()[i];
+            if (slot->hasTicketRole.load(std::memory_order_relaxed) && IsOnDiscord(*slot, now))
+                users.push_back(byDiscordUser.Keys()[i]);
+        }
+        return users;
+    }
+
+    GmPresence::Slot* GmPresence::FindAccount(uint32_t accountId) const
+    {
+        Member const* member = _directory.Get().byAccount.Find(accountId);
+        return member ? member->slot : nullptr;
+    }
+
+    GmPresence::Slot* GmPresence::FindDiscordUser(uint64_t discordUserId) const
+    {
+        Slot* const* slot = _directory.Get().byDiscordUser.Find(discordUserId);
+        return slot ? *slot : nullptr;
+    }
+
+    bool GmPresence::IsOnDiscord(Slot const& slot, int64_t now) const
+    {
+        if (slot.discordOnline.load(std::memory_order_relaxed))
+            return true;
+        int64_t seen = slot.lastInteraction.load(std::memory_order_relaxed);
+        return seen && now - seen <= _activityWindow.load(std::memory_order_relaxed);
+    }
+}
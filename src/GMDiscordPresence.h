@@ -0,0 +1,130 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_PRESENCE_H
+#define MOD_GM_DISCORD_PRESENCE_H
+
+#include "GMDiscordFlatMap.h"
+#include "GMDiscordSettings.h"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace GMDiscord
+{
+    struct GmPresenceInfo
+    {
+        uint32_t accountId = 0;
+        uint64_t discordUserId = 0;
+        std::string gmName;
+        bool inGame = false;
+        bool onDiscord = false;
+    };
+
+    // Where each linked GM account can be reached: in game (login/logout
+    // hooks), on Discord (presence updates, or an interaction within the
+    // activity window), or both. The account directory changes only on link
+    // and unlink and is published like settings; the state of each account
+    // lives in atomics, so both the world and DPP threads read without
+    // locking.
+    class GmPresence
+    {
+    public:
+        static GmPresence& Instance();
+
+        void LoadConfig();
+        // Reads linked GMs; call from the world thread.
+        void Load();
+
+        void Register(uint32_t accountId, uint64_t discordUserId, std::string const& gmName);
+        void Unregister(uint32_t accountId);
+
+        void SetInGame(uint32_t accountId, bool inGame);
+        // Both return the linked account, or 0 for users who aren't linked.
+        uint32_t SetDiscordStatus(uint64_t discordUserId, bool online);
+        // From the member's guild roles, when a presence update can see them.
+        void SetTicketRole(uint64_t discordUserId, bool hasTicketRole);
+        uint32_t OnDiscordInteraction(uint64_t discordUserId, bool hasTicketRole);
+
+        bool IsInGame(uint32_t accountId) const;
+        bool IsOnDiscord(uint32_t accountId) const;
+        // In game, or on Discord with a ticket role.
+        bool IsReachable(uint32_t accountId) const;
+
+        std::vector<GmPresenceInfo> GetAll() const;
+        // Discord users of the GMs reachable on Discord with a ticket role.
+        std::vector<uint64_t> GetDiscordReachable() const;
+
+    private:
+        // One per account for the life of the process; re-links reuse it, so
+        // a reader holding an older directory still updates the live state.
+        struct Slot
+        {
+            uint32_t accountId = 0;
+            std::atomic_bool inGame{false};
+            std::atomic_bool discordOnline{false};
+            // Unknown until the member's roles are seen.
+            std::atomic_bool hasTicketRole{false};
+            // steady_clock seconds of the last interaction; 0 if none.
+            std::atomic<int64_t> lastInteraction{0};
+        };
+
+        // What a link says about the account; replaced on re-link.
+        struct Identity
+        {
+            uint64_t discordUserId = 0;
+            std::string gmName;
+        };
+
+        struct Member
+        {
+            Slot* slot = nullptr;
+            Identity identity;
+        };
+
+        // Read on every interaction and presence update; rebuilt on writes.
+        struct Directory
+        {
+            SortedIdTable<Member> byAccount;
+            SortedIdTable<Slot*> byDiscordUser;
+        };
+
+        GmPresence() = default;
+
+        Slot* FindAccount(uint32_t accountId) const;
+        Slot* FindDiscordUser(uint64_t discordUserId) const;
+        bool IsOnDiscord(Slot const& slot, int64_t now) const;
+        void PublishLocked();
+
+        SettingsSnapshot<Directory> _directory;
+        std::atomic<int64_t> _activityWindow{900};
+
+        // Writers only. Slots are never freed (the deque keeps them in
+        // place), so a reader holding an old directory stays valid.
+        std::mutex _writeMutex;
+        std::deque<Slot> _slots;
+        std::unordered_map<uint32_t, Slot*> _slotByAccount;
+        std::unordered_map<uint32_t, Identity> _live;
+    };
+}
+
+#endif
@@ -0,0 +1,344 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GMDiscordSearch.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <system_error>
+
+#ifndef _WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace GMDiscord
+{
+    namespace
+    {
+        constexpr char SEGMENT_MAGIC[4] = { 'G', 'M', 'T', 'I' };
+        constexpr uint32_t SEGMENT_VERSION = 1;
+        constexpr size_t SEGMENT_HEADER_SIZE = 8;
+        constexpr size_t RECORD_HEADER_SIZE = 12;
+
+        constexpr size_t MIN_TERM_LENGTH = 2;
+        constexpr size_t MAX_TERM_LENGTH = 32;
+        constexpr size_t SNIPPET_LENGTH = 160;
+        constexpr double BM25_K1 = 1.2;
+        constexpr double BM25_B = 0.75;
+
+        // Lower-cased runs of ASCII alphanumerics; bytes >= 0x80 count as
+        // word characters so UTF-8 names and words stay whole.
+        template <typename F>
+        void ForEachTerm(std::string_view text, F&& fn)
+        {
+            std::string term;
+            for (size_t i = 0; i <= text.size(); ++i)
+            {
+                unsigned char ch = i < text.size() ? static_cast<unsigned char>(text[i]) : ' ';
+                if (std::isalnum(ch) || ch >= 0x80)
+                {
+                    if (term.size() < MAX_TERM_LENGTH)
+                        term.push_back(static_cast<char>(ch >= 0x80 ? ch : std::tolower(ch)));
+                    continue;
+                }
+
+                if (term.size() >= MIN_TERM_LENGTH)
+                    fn(term);
+                term.clear();
+            }
+        }
+
+        bool IsTicketField(TicketTextKind kind)
+        {
+            return kind <= TICKET_TEXT_RESPONSE;
+        }
+    }
+
+    TicketIndex& TicketIndex::Instance()
+    {
+        static TicketIndex instance;
+        return instance;
+    }
+
+    TicketIndex::~TicketIndex()
+    {
+        if (_file)
+            std::fclose(_file);
+#ifndef _WIN32
+        if (_mapping)
+            munmap(_mapping, _mappingSize);
+#endif
+    }
+
+    bool TicketIndex::Open(std::string const& path)
+    {
+        std::unique_lock<std::shared_mutex> lock(_lock);
+        if (_file)
+            return true;
+
+        std::error_code ec;
+        std::filesystem::path segmentPath(path);
+        if (segmentPath.has_parent_path())
+            std::filesystem::create_directories(segmentPath.parent_path(), ec);
+
+        char const* data = nullptr;
+        size_t size = 0;
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void* mapping = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED)
+            {
+                _mapping = mapping;
+                _mappingSize = static_cast<size_t>(st.st_size);
+                data = static_cast<char const*>(mapping);
+                size = _mappingSize;
+            }
+        }
+        if (fd >= 0)
+            ::close(fd);
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (in)
+        {
+            _fallbackBuffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            data = _fallbackBuffer.data();
+            size = _fallbackBuffer.size();
+        }
+#endif
+
+        if (size > 0 && (size < SEGMENT_HEADER_SIZE || std::memcmp(data, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0))
+        {
+            LOG_ERROR("module.gm_discord", "Ticket search index '{}' is not a segment file; search is disabled.", path);
+            return false;
+        }
+
+        size_t offset = size ? SEGMENT_HEADER_SIZE : 0;
+        while (offset + RECORD_HEADER_SIZE <= size)
+        {
+            uint32_t ticketId;
+            uint32_t at;
+            uint16_t textLength;
+            std::memcpy(&ticketId, data + offset, 4);
+            std::memcpy(&at, data + offset + 4, 4);
+            uint8_t kind = static_cast<uint8_t>(data[offset + 8]);
+            uint8_t playerLength = static_cast<uint8_t>(data[offset + 9]);
+            std::memcpy(&textLength, data + offset + 10, 2);
+
+            size_t end = offset + RECORD_HEADER_SIZE + playerLength + textLength;
+            if (end > size)
+                break;
+
+            Document document{ ticketId, at, static_cast<TicketTextKind>(kind), 0,
+                std::string_view(data + offset + RECORD_HEADER_SIZE, playerLength),
+                std::string_view(data + offset + RECORD_HEADER_SIZE + playerLength, textLength) };
+            if (IsTicketField(document.kind))
+                _lastFieldHash[(uint64_t(ticketId) << 8) | kind] = std::hash<std::string_view>{}(document.text);
+            IndexDocument(document);
+            offset = end;
+        }
+
+        if (offset < size)
+        {
+            LOG_WARN("module.gm_discord", "Ticket search index '{}' has a torn record at byte {}; truncating.", path, offset);
+            std::filesystem::resize_file(path, offset, ec);
+        }
+
+        _file = std::fopen(path.c_str(), "ab");
+        if (!_file)
+        {
+            LOG_ERROR("module.gm_discord", "Cannot open ticket search index '{}' for append.", path);
+            return false;
+        }
+
+        if (size == 0)
+        {
+            std::fwrite(SEGMENT_MAGIC, 1, sizeof(SEGMENT_MAGIC), _file);
+            std::fwrite(&SEGMENT_VERSION, sizeof(SEGMENT_VERSION), 1, _file);
+            std::fflush(_file);
+        }
+
+        LOG_INFO("module.gm_discord", "Ticket search index loaded: {} documents, {} terms.", _documents.size(), _postings.size());
+        return true;
+    }
+
+    void TicketIndex::Add(uint32_t ticketId, uint64_t at, TicketTextKind kind, std::string_view player, std::string_view text)
+    {
+        if (text.empty())
+            return;
+
+        player = player.substr(0, UINT8_MAX);
+        text = text.substr(0, UINT16_MAX);
+
+        std::unique_lock<std::shared_mutex> lock(_lock);
+        if (!_file)
+            return;
+
+        if (IsTicketField(kind))
+        {
+            size_t hash = std::hash<std::string_view>{}(text);
+            auto [it, inserted] = _lastFieldHash.try_emplace((uint64_t(ticketId) << 8) | kind, hash);
+            if (!inserted)
+            {
+                if (it->second == hash)
+                    return;
+                it->second = hash;
+            }
+        }
+
+        char header[RECORD_HEADER_SIZE];
+        uint32_t at32 = static_cast<uint32_t>(at);
+        uint16_t textLength = static_cast<uint16_t>(text.size());
+        std::memcpy(header, &ticketId, 4);
+        std::memcpy(header + 4, &at32, 4);
+        header[8] = static_cast<char>(kind);
+        header[9] = static_cast<char>(player.size());
+        std::memcpy(header + 10, &textLength, 2);
+
+        std::fwrite(header, 1, sizeof(header), _file);
+        std::fwrite(player.data(), 1, player.size(), _file);
+        std::fwrite(text.data(), 1, text.size(), _file);
+        std::fflush(_file);
+
+        std::string& stored = _appended.emplace_back();
+        stored.reserve(player.size() + text.size());
+        stored.append(player).append(text);
+
+        IndexDocument(Document{ ticketId, at32, kind, 0,
+            std::string_view(stored).substr(0, player.size()),
+            std::string_view(stored).substr(player.size()) });
+    }
+
+    void TicketIndex::IndexDocument(Document const& document)
+    {
+        std::unordered_map<std::string, uint16_t> frequencies;
+        uint32_t length = 0;
+        auto count = [&](std::string const& term)
+        {
+            uint16_t& frequency = frequencies[term];
+            if (frequency < UINT16_MAX)
+                ++frequency;
+            ++length;
+        };
+        ForEachTerm(document.player, count);
+        ForEachTerm(document.text, count);
+
+        uint32_t documentIndex = static_cast<uint32_t>(_documents.size());
+        for (auto const& [term, frequency] : frequencies)
+            _postings[term].push_back(Posting{ documentIndex, frequency });
+
+        Document& stored = _documents.emplace_back(document);
+        stored.length = static_cast<uint16_t>(std::min<uint32_t>(length, UINT16_MAX));
+        _totalLength += stored.length;
+    }
+
+    std::vector<TicketSearchHit> TicketIndex::Search(std::string_view query, size_t limit) const
+    {
+        std::vector<std::string> terms;
+        ForEachTerm(query, [&terms](std::string const& term)
+        {
+            if (std::find(terms.begin(), terms.end(), term) == terms.end())
+                terms.push_back(term);
+        });
+
+        std::vector<TicketSearchHit> hits;
+        std::shared_lock<std::shared_mutex> lock(_lock);
+        if (terms.empty() || _documents.empty() || !limit)
+            return hits;
+
+        double documentCount = static_cast<double>(_documents.size());
+        double averageLength = std::max(1.0, static_cast<double>(_totalLength) / documentCount);
+
+        std::unordered_map<uint32_t, double> documentScores;
+        for (std::string const& term : terms)
+        {
+            auto it = _postings.find(term);
+            if (it == _postings.end())
+                continue;
+
+            double df = static_cast<double>(it->second.size());
+            double idf = std::log(1.0 + (documentCount - df + 0.5) / (df + 0.5));
+            for (Posting const& posting : it->second)
+            {
+                double tf = posting.frequency;
+                double length = _documents[posting.document].length;
+                documentScores[posting.document] += idf * tf * (BM25_K1 + 1.0)
+                    / (tf + BM25_K1 * (1.0 - BM25_B + BM25_B * length / averageLength));
+            }
+        }
+
+        // Per ticket: total score, plus the best document for the snippet.
+        struct TicketScore
+        {
+            double total = 0.0;
+            double best = -1.0;
+            uint32_t document = 0;
+        };
+        std::unordered_map<uint32_t, TicketScore> tickets;
+        for (auto const& [documentIndex, score] : documentScores)
+        {
+            TicketScore& ticket = tickets[_documents[documentIndex].ticketId];
+            ticket.total += score;
+            if (score > ticket.best)
+            {
+                ticket.best = score;
+                ticket.document = documentIndex;
+            }
+        }
+
+        std::vector<std::pair<uint32_t, TicketScore>> ranked(tickets.begin(), tickets.end());
+        size_t count = std::min(limit, ranked.size());
+        std::partial_sort(ranked.begin(), ranked.begin() + count, ranked.end(), [](auto const& a, auto const& b)
+        {
+            return a.second.total != b.second.total ? a.second.total > b.second.total : a.first > b.first;
+        });
+
+        hits.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            Document const& document = _documents[ranked[i].second.document];
+            TicketSearchHit& hit = hits.emplace_back();
+            hit.ticketId = ranked[i].first;
+            hit.score = ranked[i].second.total;
+            hit.at = document.at;
+            hit.kind = document.kind;
+            hit.player = std::string(document.player);
+            hit.snippet = std::string(document.text.substr(0, SNIPPET_LENGTH));
+        }
+
+        return hits;
+    }
+
+    size_t TicketIndex::GetDocumentCount() const
+    {
+        std::shared_lock<std::shared_mutex> lock(_lock);
+        return _documents.size();
+    }
+}
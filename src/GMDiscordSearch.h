@@ -0,0 +1,117 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_SEARCH_H
+#define MOD_GM_DISCORD_SEARCH_H
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace GMDiscord
+{
+    enum TicketTextKind : uint8_t
+    {
+        TICKET_TEXT_MESSAGE        = 0,
+        TICKET_TEXT_COMMENT        = 1,
+        TICKET_TEXT_RESPONSE       = 2,
+        TICKET_TEXT_PLAYER_WHISPER = 3,
+        TICKET_TEXT_GM_WHISPER     = 4,
+    };
+
+    struct TicketSearchHit
+    {
+        uint32_t ticketId = 0;
+        double score = 0.0;
+        uint64_t at = 0;
+        TicketTextKind kind = TICKET_TEXT_MESSAGE;
+        std::string player;
+        std::string snippet;
+    };
+
+    // Inverted index over ticket text and whispers, fed from the outbox as
+    // events are dispatched. Documents are appended to a segment file:
+    //
+    //   header:  "GMTI" uint32 version
+    //   record:  uint32 ticketId, uint32 at, uint8 kind, uint8 playerLen,
+    //            uint16 textLen, player bytes, text bytes
+    //
+    // On Open the segment is memory-mapped and the postings are rebuilt from
+    // it; document text stays in the mapping. A torn last record (crash mid
+    // write) is cut off. Search never touches the database.
+    class TicketIndex
+    {
+    public:
+        static TicketIndex& Instance();
+
+        ~TicketIndex();
+
+        bool Open(std::string const& path);
+        bool IsOpen() const { return _file != nullptr; }
+
+        // Ticket fields are re-sent with every ticket event; unchanged text
+        // is skipped. Whispers are always new documents.
+        void Add(uint32_t ticketId, uint64_t at, TicketTextKind kind, std::string_view player, std::string_view text);
+
+        // BM25 over the query terms, summed per ticket; the best matching
+        // document of each ticket is returned as its snippet.
+        std::vector<TicketSearchHit> Search(std::string_view query, size_t limit) const;
+
+        size_t GetDocumentCount() const;
+
+    private:
+        struct Document
+        {
+            uint32_t ticketId;
+            uint32_t at;
+            TicketTextKind kind;
+            uint16_t length;
+            std::string_view player;
+            std::string_view text;
+        };
+
+        struct Posting
+        {
+            uint32_t document;
+            uint16_t frequency;
+        };
+
+        TicketIndex() = default;
+
+        void IndexDocument(Document const& document);
+
+        mutable std::shared_mutex _lock;
+        std::vector<Document> _documents;
+        std::unordered_map<std::string, std::vector<Posting>> _postings;
+        std::unordered_map<uint64_t, size_t> _lastFieldHash;
+        uint64_t _totalLength = 0;
+
+        // Text of documents added since Open; the rest lives in the mapping.
+        std::deque<std::string> _appended;
+        void* _mapping = nullptr;
+        size_t _mappingSize = 0;
+        std::string _fallbackBuffer;
+        std::FILE* _file = nullptr;
+    };
+}
+
+#endif
@@ -0,0 +1,163 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_SEND_QUEUE_H
+#define MOD_GM_DISCORD_SEND_QUEUE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace GMDiscord
+{
+    // One FIFO per destination channel, paced to Discord's per-channel
+    // message bucket (5 messages per 5 seconds). A busy ticket thread waits
+    // on its own bucket instead of drawing 429s that stall the shared REST
+    // queue for every other channel. Independent of DPP: Message and
+    // Callback are the bot's message and completion types.
+    template <typename Message, typename Callback>
+    class ChannelSendQueue
+    {
+    public:
+        static constexpr uint32_t BURST = 5;
+        static constexpr uint64_t WINDOW_MS = 5000;
+        // Per channel; past it Push fails. Callers that can retry later
+        // (the outbox) check HasRoom first instead of losing the message.
+        static constexpr size_t MAX_DEPTH = 250;
+
+        struct Ready
+        {
+            uint64_t channelId;
+            Message message;
+            Callback callback;
+            // Edit of an existing message rather than a new post.
+            bool edit;
+        };
+
+        // False when the channel's queue is full. Edits share the channel's
+        // bucket with new posts and are never merged.
+        bool Push(uint64_t channelId, Message message, Callback callback = { }, bool edit = false)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            Channel& channel = _channels[channelId];
+            if (channel.pending.size() >= MAX_DEPTH)
+                return false;
+
+            channel.pending.push_back({ std::move(message), std::move(callback), edit });
+            ++_pending;
+            return true;
+        }
+
+        bool HasRoom(uint64_t channelId) const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _channels.find(channelId);
+            return it == _channels.end() || it->second.pending.size() < MAX_DEPTH;
+        }
+
+        // Pops what each channel's bucket allows at `nowMs`. Consecutive
+        // queued messages without callbacks are combined while
+        // `merge(into, next)` accepts; `merged` counts the absorbed ones.
+        template <typename Merge>
+        std::vector<Ready> TakeReady(uint64_t nowMs, Merge&& merge, uint64_t& merged)
+        {
+            std::vector<Ready> ready;
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto it = _channels.begin(); it != _channels.end();)
+            {
+                Channel& channel = it->second;
+                while (!channel.sent.empty() && nowMs - channel.sent.front() >= WINDOW_MS)
+                    channel.sent.pop_front();
+
+                while (!channel.pending.empty() && channel.sent.size() < BURST && nowMs >= channel.blockedUntil)
+                {
+                    Entry entry = std::move(channel.pending.front());
+                    channel.pending.pop_front();
+                    --_pending;
+                    while (!entry.callback && !entry.edit && !channel.pending.empty() && !channel.pending.front().callback &&
+                        !channel.pending.front().edit && merge(entry.message, channel.pending.front().message))
+                    {
+                        channel.pending.pop_front();
+                        --_pending;
+                        ++merged;
+                    }
+
+                    ready.push_back({ it->first, std::move(entry.message), std::move(entry.callback), entry.edit });
+                    channel.sent.push_back(nowMs);
+                }
+
+                if (channel.pending.empty() && channel.sent.empty())
+                    it = _channels.erase(it);
+                else
+                    ++it;
+            }
+            return ready;
+        }
+
+        // Holds a channel after Discord rate limited it anyway.
+        void Defer(uint64_t channelId, uint64_t untilMs)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _channels.find(channelId);
+            if (it != _channels.end())
+                it->second.blockedUntil = std::max(it->second.blockedUntil, untilMs);
+        }
+
+        // Channels with queued messages and their depth.
+        std::vector<std::pair<uint64_t, size_t>> GetDepths() const
+        {
+            std::vector<std::pair<uint64_t, size_t>> depths;
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto const& [channelId, channel] : _channels)
+                if (!channel.pending.empty())
+                    depths.emplace_back(channelId, channel.pending.size());
+            return depths;
+        }
+
+        size_t GetPending() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _pending;
+        }
+
+    private:
+        struct Entry
+        {
+            Message message;
+            Callback callback;
+            bool edit;
+        };
+
+        struct Channel
+        {
+            std::deque<Entry> pending;
+            // Send times still inside the bucket window.
+            std::deque<uint64_t> sent;
+            uint64_t blockedUntil = 0;
+        };
+
+        mutable std::mutex _mutex;
+        std::unordered_map<uint64_t, Channel> _channels;
+        size_t _pending = 0;
+    };
+}
+
+#endif
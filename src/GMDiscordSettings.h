@@ -0,0 +1,82 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_SETTINGS_H
+#define MOD_GM_DISCORD_SETTINGS_H
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace GMDiscord
+{
+    // Immutable settings published by `.reload config` and read from the
+    // world and DPP threads. Readers take a single acquire load and keep the
+    // reference for the duration of one handler; writers publish a fresh
+    // object. A replaced version is freed by a later Publish once it has
+    // been retired for RETIRE_GRACE, far longer than any handler runs.
+    template <typename T>
+    class SettingsSnapshot
+    {
+    public:
+        SettingsSnapshot()
+        {
+            Publish(std::make_unique<T const>());
+        }
+
+        SettingsSnapshot(SettingsSnapshot const&) = delete;
+        SettingsSnapshot& operator=(SettingsSnapshot const&) = delete;
+
+        T const& Get() const
+        {
+            return *_current.load(std::memory_order_acquire);
+        }
+
+        void Publish(std::unique_ptr<T const> next)
+        {
+            Clock::time_point now = Clock::now();
+            std::lock_guard<std::mutex> lock(_mutex);
+            _current.store(next.get(), std::memory_order_release);
+            if (_live)
+                _retired.push_back({ std::move(_live), now });
+            _live = std::move(next);
+
+            while (!_retired.empty() && now - _retired.front().retiredAt >= RETIRE_GRACE)
+                _retired.pop_front();
+        }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr std::chrono::minutes RETIRE_GRACE{10};
+
+        struct Retired
+        {
+            std::unique_ptr<T const> version;
+            Clock::time_point retiredAt;
+        };
+
+        std::atomic<T const*> _current{nullptr};
+        std::mutex _mutex;
+        std::unique_ptr<T const> _live;
+        std::deque<Retired> _retired;
+    };
+}
+
+#endif
@@ -0,0 +1,512 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GMDiscordSpill.h"
+#include "GMDiscordDatabase.h"
+#include "GMDiscordMetrics.h"
+
+#include "Config.h"
+#include "DatabaseEnv.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <chrono>
+
+#ifdef _WIN32
+#  include <io.h>
+#else
+#  include <unistd.h>
+#endif
+
+namespace GMDiscord
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        constexpr uint32_t REPLAY_PROBE_EVERY = 256;
+
+        static void WriteLength(std::FILE* file, uint32_t length)
+        {
+            unsigned char bytes[4] =
+            {
+                static_cast<unsigned char>(length & 0xFF),
+                static_cast<unsigned char>((length >> 8) & 0xFF),
+                static_cast<unsigned char>((length >> 16) & 0xFF),
+                static_cast<unsigned char>((length >> 24) & 0xFF)
+            };
+            std::fwrite(bytes, 1, sizeof(bytes), file);
+        }
+
+        static bool ReadLength(std::FILE* file, uint32_t& length)
+        {
+            unsigned char bytes[4];
+            if (std::fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes))
+                return false;
+
+            length = uint32_t(bytes[0]) | (uint32_t(bytes[1]) << 8) | (uint32_t(bytes[2]) << 16) | (uint32_t(bytes[3]) << 24);
+            return true;
+        }
+
+        static void SyncHandle(std::FILE* file)
+        {
+            std::fflush(file);
+#ifdef _WIN32
+            _commit(_fileno(file));
+#else
+            fsync(fileno(file));
+#endif
+        }
+
+        // Replay progress lives next to the spill file, so a crash mid-replay
+        // re-applies at most one batch instead of the whole file.
+        static std::string GetOffsetPath(std::string const& path)
+        {
+            return path + ".offset";
+        }
+
+        static void WriteReplayOffset(std::string const& path, uint64_t offset)
+        {
+            std::FILE* file = std::fopen(GetOffsetPath(path).c_str(), "wb");
+            if (!file)
+                return;
+
+            unsigned char bytes[8];
+            for (uint32_t i = 0; i < 8; ++i)
+                bytes[i] = static_cast<unsigned char>((offset >> (i * 8)) & 0xFF);
+            std::fwrite(bytes, 1, sizeof(bytes), file);
+            SyncHandle(file);
+            std::fclose(file);
+        }
+
+        static uint64_t ReadReplayOffset(std::string const& path)
+        {
+            std::FILE* file = std::fopen(GetOffsetPath(path).c_str(), "rb");
+            if (!file)
+                return 0;
+
+            unsigned char bytes[8];
+            uint64_t offset = 0;
+            if (std::fread(bytes, 1, sizeof(bytes), file) == sizeof(bytes))
+                for (uint32_t i = 0; i < 8; ++i)
+                    offset |= uint64_t(bytes[i]) << (i * 8);
+            std::fclose(file);
+            return offset;
+        }
+
+        static uint64_t GetFileSize(std::string const& path)
+        {
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            if (!file)
+                return 0;
+
+            std::fseek(file, 0, SEEK_END);
+            long size = std::ftell(file);
+            std::fclose(file);
+            return size > 0 ? static_cast<uint64_t>(size) : 0;
+        }
+
+        // Whole records from `offset` to `size`; a truncated tail is not one.
+        static uint64_t CountRecords(std::string const& path, uint64_t offset, uint64_t size)
+        {
+            std::FILE* file = std::fopen(path.c_str(), "rb");
+            if (!file)
+                return 0;
+
+            uint64_t records = 0;
+            uint32_t length = 0;
+            while (std::fseek(file, static_cast<long>(offset), SEEK_SET) == 0 && ReadLength(file, length) &&
+                offset + sizeof(uint32_t) + length <= size)
+            {
+                offset += sizeof(uint32_t) + length;
+                ++records;
+            }
+            std::fclose(file);
+            return records;
+        }
+    }
+
+    SpillQueue& SpillQueue::Instance()
+    {
+        static SpillQueue instance;
+        return instance;
+    }
+
+    void SpillQueue::LoadConfig()
+    {
+        Config config;
+        config.enabled = sConfigMgr->GetOption<bool>("GMDiscord.Spill.Enable", true);
+        config.path = sConfigMgr->GetOption<std::string>("GMDiscord.Spill.Path", "gm_discord_spill.bin");
+        config.maxBytes = sConfigMgr->GetOption<uint64_t>("GMDiscord.Spill.MaxBytes", 64 * 1024 * 1024);
+        config.probeIntervalMs = std::max<uint32_t>(100, sConfigMgr->GetOption<uint32_t>("GMDiscord.Spill.ProbeIntervalMs", 1000));
+        config.latencyThresholdMs = sConfigMgr->GetOption<uint32_t>("GMDiscord.Spill.LatencyThresholdMs", 500);
+        config.queueThreshold = sConfigMgr->GetOption<uint32_t>("GMDiscord.Spill.QueueThreshold", 5000);
+        config.failureThreshold = std::max<uint32_t>(1, sConfigMgr->GetOption<uint32_t>("GMDiscord.Spill.FailureThreshold", 3));
+        config.fsyncBatch = std::max<uint32_t>(1, sConfigMgr->GetOption<uint32_t>("GMDiscord.Spill.FsyncBatch", 64));
+        config.fsyncIntervalMs = sConfigMgr->GetOption<uint32_t>("GMDiscord.Spill.FsyncIntervalMs", 200);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        // The spill file cannot move while the thread owns it.
+        if (_running && !_config.path.empty())
+            config.path = _config.path;
+        _config = config;
+        _queueThreshold.store(config.queueThreshold, std::memory_order_relaxed);
+        _active.store(config.enabled && _running, std::memory_order_release);
+    }
+
+    void SpillQueue::Start()
+    {
+        if (_running.exchange(true))
+            return;
+
+        std::string path;
+        bool enabled = false;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            path = _config.path;
+            enabled = _config.enabled;
+        }
+
+        if (path.empty())
+        {
+            LOG_ERROR("module.gm_discord", "Spill queue disabled: GMDiscord.Spill.Path is empty.");
+            _running = false;
+            return;
+        }
+
+        // Leftovers from a previous run must be replayed before anything new
+        // reaches the DB, so start in degraded mode until the file drains.
+        _fileBytes = GetFileSize(path);
+        _replayOffset = ReadReplayOffset(path);
+        if (_replayOffset > _fileBytes)
+            _replayOffset = 0;
+        if (_fileBytes && _replayOffset == _fileBytes)
+        {
+            // Fully replayed before a crash that skipped the cleanup.
+            std::remove(path.c_str());
+            std::remove(GetOffsetPath(path).c_str());
+            _fileBytes = 0;
+            _replayOffset = 0;
+        }
+
+        if (_fileBytes > 0)
+        {
+            _spilledRecords.store(CountRecords(path, _replayOffset, _fileBytes), std::memory_order_relaxed);
+            LOG_WARN("module.gm_discord", "Spill file {} holds {} unreplayed statements from a previous run; replaying once the DB is healthy.",
+                path, _spilledRecords.load(std::memory_order_relaxed));
+            _degraded = true;
+        }
+        else if (!enabled)
+        {
+            _running = false;
+            return;
+        }
+
+        _active.store(enabled, std::memory_order_release);
+        _thread = std::thread([this]() { Run(); });
+    }
+
+    void SpillQueue::Stop()
+    {
+        if (!_running.exchange(false))
+            return;
+
+        _active.store(false, std::memory_order_release);
+        _cv.notify_all();
+        if (_thread.joinable())
+            _thread.join();
+    }
+
+    void SpillQueue::Execute(std::string_view sql, bool sheddable)
+    {
+        if (!_degraded.load(std::memory_order_acquire))
+        {
+            uint32_t queueThreshold = _queueThreshold.load(std::memory_order_relaxed);
+            if (!_active.load(std::memory_order_acquire) || !queueThreshold || ModuleDB().QueueSize() < queueThreshold)
+            {
+                ModuleDB().Execute(sql);
+                return;
+            }
+
+            if (!_degraded.exchange(true))
+                LOG_WARN("module.gm_discord", "Characters DB async queue above {} statements; spilling module writes to disk.",
+                    queueThreshold);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            // Recovery flips the flag under this lock once the file is drained.
+            if (_degraded.load(std::memory_order_relaxed))
+            {
+                // Once spilling, every statement goes behind the older ones;
+                // the DB queue would apply it ahead of them.
+                uint64_t recordBytes = sizeof(uint32_t) + sql.size();
+                if (_fileBytes + _pendingBytes + recordBytes > _config.maxBytes)
+                {
+                    if (!_overCapLogged)
+                    {
+                        _overCapLogged = true;
+                        LOG_ERROR("module.gm_discord", "Spill file {} is past GMDiscord.Spill.MaxBytes; dropping audit and stats rows, still spilling the rest to keep module writes in order.",
+                            _config.path);
+                    }
+
+                    if (sheddable)
+                    {
+                        static std::atomic<uint64_t>& shed = Metrics::Instance().Get("spill.shed");
+                        shed.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+
+                _pendingBytes += recordBytes;
+                _pending.emplace_back(sql);
+                _cv.notify_one();
+                return;
+            }
+        }
+
+        ModuleDB().Execute(sql);
+    }
+
+    size_t SpillQueue::GetPendingCount() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _pending.size() + _spilledRecords.load(std::memory_order_relaxed);
+    }
+
+    void SpillQueue::Run()
+    {
+        Clock::time_point lastProbe = Clock::now();
+        Clock::time_point lastSync = lastProbe;
+
+        while (_running)
+        {
+            Config config;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                uint32_t waitMs = std::min(_config.probeIntervalMs, std::max<uint32_t>(_config.fsyncIntervalMs, 10));
+                _cv.wait_for(lock, std::chrono::milliseconds(waitMs), [this]() { return !_running || !_pending.empty(); });
+                config = _config;
+            }
+
+            AppendPending(config);
+
+            Clock::time_point now = Clock::now();
+            if (_unsyncedRecords >= config.fsyncBatch ||
+                (_unsyncedRecords > 0 && now - lastSync >= std::chrono::milliseconds(config.fsyncIntervalMs)))
+            {
+                SyncFile();
+                lastSync = now;
+            }
+
+            if (now - lastProbe < std::chrono::milliseconds(config.probeIntervalMs))
+                continue;
+
+            lastProbe = now;
+            if (Probe(config))
+            {
+                _failedProbes = 0;
+                if (_degraded && Replay(config))
+                    LOG_INFO("module.gm_discord", "Characters DB healthy again; spill file drained.");
+            }
+            else if (++_failedProbes >= config.failureThreshold && config.enabled && !_degraded.exchange(true))
+            {
+                LOG_WARN("module.gm_discord", "Characters DB unhealthy after {} probes; spilling module writes to {}.",
+                    _failedProbes, config.path);
+            }
+        }
+
+        // Persist whatever is still queued so the next boot replays it.
+        Config config;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            config = _config;
+        }
+
+        if (!AppendPending(config))
+        {
+            // Shutting down with nowhere to spill to; the DB queue is the last resort.
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (std::string const& sql : _pending)
+                ModuleDB().Execute(sql);
+            _pending.clear();
+            _pendingBytes = 0;
+        }
+        SyncFile();
+        CloseWriter();
+    }
+
+    bool SpillQueue::Probe(Config const& config)
+    {
+        Clock::time_point start = Clock::now();
+        QueryResult result = ModuleDB().Query("SELECT 1");
+        uint64_t elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start).count();
+
+        if (!result)
+            return false;
+        if (config.latencyThresholdMs && elapsedMs > config.latencyThresholdMs)
+            return false;
+        if (config.queueThreshold && ModuleDB().QueueSize() >= config.queueThreshold)
+            return false;
+        return true;
+    }
+
+    bool SpillQueue::AppendPending(Config const& config)
+    {
+        std::deque<std::string> batch;
+        uint64_t batchBytes = 0;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            batch.swap(_pending);
+            batchBytes = _pendingBytes;
+            _pendingBytes = 0;
+        }
+
+        if (batch.empty())
+            return true;
+
+        if (!OpenWriter(config.path))
+        {
+            // Keep them in memory, ahead of anything queued since; the next
+            // pass retries the file, and replay drains memory after it.
+            LOG_ERROR("module.gm_discord", "Cannot open spill file {}; holding {} statements in memory.",
+                config.path, batch.size());
+            std::lock_guard<std::mutex> lock(_mutex);
+            batch.insert(batch.end(), std::make_move_iterator(_pending.begin()), std::make_move_iterator(_pending.end()));
+            _pending.swap(batch);
+            _pendingBytes += batchBytes;
+            return false;
+        }
+
+        for (std::string const& sql : batch)
+        {
+            WriteLength(_file, static_cast<uint32_t>(sql.size()));
+            std::fwrite(sql.data(), 1, sql.size(), _file);
+            ++_unsyncedRecords;
+        }
+
+        _spilledRecords.fetch_add(batch.size(), std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _fileBytes += batchBytes;
+        return true;
+    }
+
+    bool SpillQueue::Replay(Config const& config)
+    {
+        // Statements already in the async queue are older than the file's
+        // head; DirectExecute would overtake them.
+        if (ModuleDB().QueueSize())
+            return false;
+
+        AppendPending(config);
+        SyncFile();
+
+        std::FILE* reader = std::fopen(config.path.c_str(), "rb");
+        if (reader)
+        {
+            std::fseek(reader, static_cast<long>(_replayOffset), SEEK_SET);
+
+            uint32_t replayed = 0;
+            std::string sql;
+            uint32_t length = 0;
+            while (ReadLength(reader, length))
+            {
+                sql.resize(length);
+                if (length && std::fread(sql.data(), 1, length, reader) != length)
+                {
+                    LOG_ERROR("module.gm_discord", "Spill file {} ends with a truncated record; discarding it.", config.path);
+                    break;
+                }
+
+                ModuleDB().DirectExecute(sql);
+                _replayOffset += sizeof(uint32_t) + length;
+                if (_spilledRecords.load(std::memory_order_relaxed))
+                    _spilledRecords.fetch_sub(1, std::memory_order_relaxed);
+
+                ++replayed;
+                if (replayed % config.fsyncBatch == 0)
+                    WriteReplayOffset(config.path, _replayOffset);
+
+                if (replayed % REPLAY_PROBE_EVERY == 0 && !Probe(config))
+                {
+                    WriteReplayOffset(config.path, _replayOffset);
+                    std::fclose(reader);
+                    return false;
+                }
+            }
+
+            std::fclose(reader);
+        }
+
+        // The file is done; statements that arrived meanwhile (or that the
+        // file could not take) are newer, so they follow it directly.
+        for (;;)
+        {
+            std::deque<std::string> batch;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_pending.empty())
+                {
+                    CloseWriter();
+                    std::remove(config.path.c_str());
+                    std::remove(GetOffsetPath(config.path).c_str());
+                    _fileBytes = 0;
+                    _replayOffset = 0;
+                    _overCapLogged = false;
+                    _spilledRecords.store(0, std::memory_order_relaxed);
+                    _degraded.store(false, std::memory_order_release);
+                    return true;
+                }
+
+                batch.swap(_pending);
+                _pendingBytes = 0;
+            }
+
+            for (std::string const& sql : batch)
+                ModuleDB().DirectExecute(sql);
+        }
+    }
+
+    void SpillQueue::SyncFile()
+    {
+        if (!_file || !_unsyncedRecords)
+            return;
+
+        SyncHandle(_file);
+        _unsyncedRecords = 0;
+    }
+
+    bool SpillQueue::OpenWriter(std::string const& path)
+    {
+        if (_file)
+            return true;
+
+        _file = std::fopen(path.c_str(), "ab");
+        return _file != nullptr;
+    }
+
+    void SpillQueue::CloseWriter()
+    {
+        if (!_file)
+            return;
+
+        SyncFile();
+        std::fclose(_file);
+        _file = nullptr;
+    }
+}
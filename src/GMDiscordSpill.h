@@ -0,0 +1,103 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_SPILL_H
+#define MOD_GM_DISCORD_SPILL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace GMDiscord
+{
+    // Write path for fire-and-forget module statements (outbox, audit, inbox).
+    // While the characters DB is healthy statements go straight to its async
+    // queue. When probes fail, get slow, or that queue backs up, statements
+    // are appended to a local length-prefixed spill file instead and replayed
+    // in order by a background thread once the DB recovers.
+    class SpillQueue
+    {
+    public:
+        static SpillQueue& Instance();
+
+        void LoadConfig();
+        void Start();
+        void Stop();
+
+        // Never performs blocking I/O on the calling thread. Once the spill is
+        // past MaxBytes, sheddable statements (audit, stats) are dropped so the
+        // writes the module depends on keep the room.
+        void Execute(std::string_view sql, bool sheddable = false);
+
+        bool IsDegraded() const { return _degraded.load(std::memory_order_acquire); }
+        // Statements waiting for the DB, in memory or on disk.
+        size_t GetPendingCount() const;
+
+    private:
+        struct Config
+        {
+            bool enabled = true;
+            std::string path;
+            uint64_t maxBytes = 64 * 1024 * 1024;
+            uint32_t probeIntervalMs = 1000;
+            uint32_t latencyThresholdMs = 500;
+            uint32_t queueThreshold = 5000;
+            uint32_t failureThreshold = 3;
+            uint32_t fsyncBatch = 64;
+            uint32_t fsyncIntervalMs = 200;
+        };
+
+        SpillQueue() = default;
+
+        void Run();
+        bool Probe(Config const& config);
+        bool AppendPending(Config const& config);
+        bool Replay(Config const& config);
+        void SyncFile();
+        bool OpenWriter(std::string const& path);
+        void CloseWriter();
+
+        Config _config;
+        mutable std::mutex _mutex;
+        std::condition_variable _cv;
+        std::deque<std::string> _pending;
+        uint64_t _pendingBytes = 0;
+        uint64_t _fileBytes = 0;
+        bool _overCapLogged = false;
+
+        std::atomic_bool _degraded{false};
+        std::atomic_bool _active{false};
+        std::atomic<uint32_t> _queueThreshold{0};
+        std::atomic_bool _running{false};
+        std::atomic<uint64_t> _spilledRecords{0};
+        std::thread _thread;
+
+        // Owned by the spill thread.
+        std::FILE* _file = nullptr;
+        uint64_t _replayOffset = 0;
+        uint32_t _unsyncedRecords = 0;
+        uint32_t _failedProbes = 0;
+    };
+}
+
+#endif
@@ -0,0 +1,243 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GMDiscordTicketLinks.h"
+#include "GMDiscordDatabase.h"
+#include "GMDiscordMetrics.h"
+#include "GMDiscordSpill.h"
+
+#include "Config.h"
+#include "DatabaseEnv.h"
+#include "StringFormat.h"
+
+#include <algorithm>
+
+namespace GMDiscord
+{
+    TicketLinkCache& TicketLinkCache::Instance()
+    {
+        static TicketLinkCache instance;
+        return instance;
+    }
+
+    TicketLinkCache::TicketLinkCache() :
+        _hits(Metrics::Instance().Get("ticket_cache.hits")),
+        _misses(Metrics::Instance().Get("ticket_cache.misses")),
+        _evictions(Metrics::Instance().Get("ticket_cache.evictions")),
+        _size(Metrics::Instance().Get("ticket_cache.entries"))
+    {
+    }
+
+    void TicketLinkCache::LoadConfig()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t maxBytes = size_t(sConfigMgr->GetOption<uint32>("GMDiscord.Bot.TicketCache.MaxKilobytes", 1024)) * 1024;
+        _maxEntries = std::max<size_t>(1, maxBytes / ENTRY_BYTES);
+        EvictOverCap();
+    }
+
+    bool TicketLinkCache::Get(uint32_t ticketId, TicketLink& link)
+    {
+        // Id 0 is the free-slot key of the flat maps.
+        if (!ticketId)
+            return false;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (Entry* entry = _entries.Find(ticketId))
+            {
+                _hits.fetch_add(1, std::memory_order_relaxed);
+                _recent.splice(_recent.begin(), _recent, entry->recent);
+                link = entry->link;
+                return link.messageId || link.threadId;
+            }
+        }
+
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        TicketLink loaded;
+        if (QueryResult result = ModuleDB().Query(Acore::StringFormat(
+            "SELECT message_id, thread_id FROM gm_discord_ticket_thread WHERE ticket_id={}", ticketId)))
+        {
+            loaded.messageId = (*result)[0].Get<uint64>();
+            loaded.threadId = (*result)[1].Get<uint64>();
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        // A SetMessage/SetThread that landed while the lock was released is
+        // newer than the row just read.
+        if (Entry* entry = _entries.Find(ticketId))
+        {
+            _recent.splice(_recent.begin(), _recent, entry->recent);
+            link = entry->link;
+            return link.messageId || link.threadId;
+        }
+
+        // Remembered either way: events for tickets without a post are common.
+        Touch(ticketId, loaded);
+        link = loaded;
+        return link.messageId || link.threadId;
+    }
+
+    bool TicketLinkCache::GetTicketByThread(uint64_t threadId, uint32_t& ticketId)
+    {
+        if (!threadId)
+            return false;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (uint32_t const* cached = _ticketByThread.Find(threadId))
+            {
+                _hits.fetch_add(1, std::memory_order_relaxed);
+                ticketId = *cached;
+                _recent.splice(_recent.begin(), _recent, _entries.Find(ticketId)->recent);
+                return true;
+            }
+
+            if (_threadMisses.Find(threadId))
+            {
+                _hits.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        _misses.fetch_add(1, std::memory_order_relaxed);
+        QueryResult result = ModuleDB().Query(Acore::StringFormat(
+            "SELECT ticket_id, message_id FROM gm_discord_ticket_thread WHERE thread_id={} LIMIT 1", threadId));
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!result)
+        {
+            if (_threadMisses.size() >= MAX_THREAD_MISSES)
+                _threadMisses.Clear();
+            _threadMisses[threadId] = 1;
+            return false;
+        }
+
+        if (uint32_t const* cached = _ticketByThread.Find(threadId))
+        {
+            ticketId = *cached;
+            return true;
+        }
+
+        ticketId = (*result)[0].Get<uint32>();
+        // Same race as in Get: never overwrite a fresher cached entry.
+        if (!_entries.Find(ticketId))
+            Touch(ticketId, { (*result)[1].Get<uint64>(), threadId });
+        return true;
+    }
+
+    bool TicketLinkCache::PeekTicketByThread(uint64_t threadId, uint32_t& ticketId)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        uint32_t const* cached = _ticketByThread.Find(threadId);
+        if (!cached)
+            return false;
+
+        ticketId = *cached;
+        return true;
+    }
+
+    void TicketLinkCache::SetMessage(uint32_t ticketId, uint64_t messageId)
+    {
+        if (!ticketId)
+            return;
+
+        // Loads the row first so the cached entry keeps the other id.
+        TicketLink link;
+        Get(ticketId, link);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            Entry const* entry = _entries.Find(ticketId);
+            Touch(ticketId, { messageId, entry ? entry->link.threadId : link.threadId });
+        }
+
+        SpillQueue::Instance().Execute(Acore::StringFormat(
+            "INSERT INTO gm_discord_ticket_thread (ticket_id, message_id) VALUES ({}, {}) "
+            "ON DUPLICATE KEY UPDATE message_id=VALUES(message_id)", ticketId, messageId));
+    }
+
+    void TicketLinkCache::SetThread(uint32_t ticketId, uint64_t threadId)
+    {
+        if (!ticketId)
+            return;
+
+        TicketLink link;
+        Get(ticketId, link);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            Entry const* entry = _entries.Find(ticketId);
+            Touch(ticketId, { entry ? entry->link.messageId : link.messageId, threadId });
+            _threadMisses.Erase(threadId);
+        }
+
+        SpillQueue::Instance().Execute(Acore::StringFormat(
+            "INSERT INTO gm_discord_ticket_thread (ticket_id, thread_id) VALUES ({}, {}) "
+            "ON DUPLICATE KEY UPDATE thread_id=VALUES(thread_id)", ticketId, threadId));
+    }
+
+    void TicketLinkCache::ClearThread(uint32_t ticketId)
+    {
+        if (!ticketId)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (Entry const* entry = _entries.Find(ticketId))
+                Touch(ticketId, { entry->link.messageId, 0 });
+        }
+
+        SpillQueue::Instance().Execute(Acore::StringFormat(
+            "UPDATE gm_discord_ticket_thread SET thread_id=0 WHERE ticket_id={}", ticketId));
+    }
+
+    void TicketLinkCache::Touch(uint32_t ticketId, TicketLink const& link)
+    {
+        bool inserted;
+        Entry& entry = _entries.Emplace(ticketId, inserted);
+        if (inserted)
+        {
+            _recent.push_front(ticketId);
+            entry.recent = _recent.begin();
+        }
+        else
+        {
+            _recent.splice(_recent.begin(), _recent, entry.recent);
+            if (entry.link.threadId && entry.link.threadId != link.threadId)
+                _ticketByThread.Erase(entry.link.threadId);
+        }
+
+        entry.link = link;
+        if (link.threadId)
+            _ticketByThread[link.threadId] = ticketId;
+
+        EvictOverCap();
+        _size.store(_entries.size(), std::memory_order_relaxed);
+    }
+
+    void TicketLinkCache::EvictOverCap()
+    {
+        while (_entries.size() > _maxEntries)
+        {
+            uint32_t ticketId = _recent.back();
+            _recent.pop_back();
+            if (uint64_t threadId = _entries.Find(ticketId)->link.threadId)
+                _ticketByThread.Erase(threadId);
+            _entries.Erase(ticketId);
+            _evictions.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
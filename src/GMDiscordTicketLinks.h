@@ -0,0 +1,92 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_TICKET_LINKS_H
+#define MOD_GM_DISCORD_TICKET_LINKS_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+
+#include "GMDiscordFlatMap.h"
+
+namespace GMDiscord
+{
+    // Discord objects of one ticket: its outbox message (edit target) and
+    // the thread started from it.
+    struct TicketLink
+    {
+        uint64_t messageId = 0;
+        uint64_t threadId = 0;
+    };
+
+    // Ticket <-> message/thread ids, persisted in gm_discord_ticket_thread
+    // and cached in memory up to MaxKilobytes. Past the cap the least
+    // recently used ticket is evicted; a miss reads the table by primary
+    // key (ticket) or thread index. Used from DPP threads.
+    class TicketLinkCache
+    {
+    public:
+        static TicketLinkCache& Instance();
+
+        void LoadConfig();
+
+        bool Get(uint32_t ticketId, TicketLink& link);
+        bool GetTicketByThread(uint64_t threadId, uint32_t& ticketId);
+        // Cache only, for when the database must not be touched.
+        bool PeekTicketByThread(uint64_t threadId, uint32_t& ticketId);
+
+        void SetMessage(uint32_t ticketId, uint64_t messageId);
+        void SetThread(uint32_t ticketId, uint64_t threadId);
+        // The thread was archived with its ticket; the message stays.
+        void ClearThread(uint32_t ticketId);
+
+    private:
+        struct Entry
+        {
+            TicketLink link;
+            std::list<uint32_t>::iterator recent;
+        };
+
+        // Entry, LRU node and both hash nodes, rounded up.
+        static constexpr size_t ENTRY_BYTES = 128;
+        // Channels known not to be ticket threads, cleared when full.
+        static constexpr size_t MAX_THREAD_MISSES = 4096;
+
+        TicketLinkCache();
+
+        // Callers hold _mutex.
+        void Touch(uint32_t ticketId, TicketLink const& link);
+        void EvictOverCap();
+
+        std::mutex _mutex;
+        size_t _maxEntries = 8192;
+        FlatIdMap<Entry> _entries;
+        FlatIdMap<uint32_t> _ticketByThread;
+        FlatIdMap<uint8_t> _threadMisses;
+        // Most recently used first.
+        std::list<uint32_t> _recent;
+
+        std::atomic<uint64_t>& _hits;
+        std::atomic<uint64_t>& _misses;
+        std::atomic<uint64_t>& _evictions;
+        std::atomic<uint64_t>& _size;
+    };
+}
+
+#endif
@@ -0,0 +1,250 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GMDiscordTicketStats.h"
+#include "GMDiscordSpill.h"
+
+#include "DatabaseEnv.h"
+#include "StringFormat.h"
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+namespace GMDiscord
+{
+    namespace
+    {
+        constexpr std::array<char const*, TicketStats::MAX_METRICS> METRIC_NAMES = { "first_response", "assign", "close" };
+        constexpr size_t RENDER_MAX_GMS = 10;
+
+        static std::string FormatDuration(uint64_t seconds)
+        {
+            if (seconds < 60)
+                return Acore::StringFormat("{}s", seconds);
+            if (seconds < 3600)
+                return Acore::StringFormat("{}m", seconds / 60);
+            if (seconds < 86400)
+                return Acore::StringFormat("{}h{}m", seconds / 3600, (seconds % 3600) / 60);
+            return Acore::StringFormat("{}d{}h", seconds / 86400, (seconds % 86400) / 3600);
+        }
+
+        static std::string FormatPercentiles(DurationHistogram const& histogram)
+        {
+            if (!histogram.GetCount())
+                return "-";
+            return Acore::StringFormat("{}/{}", FormatDuration(histogram.GetPercentile(0.5)),
+                FormatDuration(histogram.GetPercentile(0.9)));
+        }
+
+        static std::string EscapeSql(std::string const& input)
+        {
+            std::string escaped = input;
+            CharacterDatabase.EscapeString(escaped);
+            return escaped;
+        }
+    }
+
+    uint32_t DurationHistogram::BucketFor(uint64_t value)
+    {
+        value = std::min<uint64_t>(value, UINT32_MAX);
+        if (value < 16)
+            return static_cast<uint32_t>(value);
+
+        uint32_t exponent = static_cast<uint32_t>(std::bit_width(value)) - 1;
+        uint32_t sub = static_cast<uint32_t>(value >> (exponent - 3)) & 7;
+        return 16 + (exponent - 4) * 8 + sub;
+    }
+
+    uint64_t DurationHistogram::UpperBound(uint32_t bucket)
+    {
+        if (bucket < 16)
+            return bucket;
+
+        uint32_t exponent = 4 + (bucket - 16) / 8;
+        uint64_t sub = (bucket - 16) % 8;
+        uint64_t width = uint64_t(1) << (exponent - 3);
+        return (8 + sub) * width + width - 1;
+    }
+
+    void DurationHistogram::Record(uint64_t value)
+    {
+        ++_buckets[BucketFor(value)];
+        ++_count;
+        _max = std::max(_max, value);
+    }
+
+    void DurationHistogram::Merge(DurationHistogram const& other)
+    {
+        for (uint32_t i = 0; i < BUCKETS; ++i)
+            _buckets[i] += other._buckets[i];
+        _count += other._count;
+        _max = std::max(_max, other._max);
+    }
+
+    uint64_t DurationHistogram::GetPercentile(double q) const
+    {
+        if (!_count)
+            return 0;
+
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * double(_count) + 0.5));
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < BUCKETS; ++i)
+        {
+            seen += _buckets[i];
+            if (seen >= rank)
+                return std::min(UpperBound(i), _max);
+        }
+
+        return _max;
+    }
+
+    TicketStats& TicketStats::Instance()
+    {
+        static TicketStats instance;
+        return instance;
+    }
+
+    TicketStats::OpenTicket& TicketStats::Track(uint32_t ticketId, uint64_t createTime)
+    {
+        // Tickets opened before startup are picked up on their first event.
+        OpenTicket& ticket = _open[ticketId];
+        if (!ticket.createTime)
+            ticket.createTime = createTime;
+        return ticket;
+    }
+
+    void TicketStats::Record(Metric metric, uint64_t createTime, std::string_view gmName, uint64_t now)
+    {
+        uint64_t elapsed = now > createTime ? now - createTime : 0;
+        Series& gm = _byGm[gmName.empty() ? std::string("unassigned") : std::string(gmName)];
+        Series& hour = _byHour[(createTime % 86400) / 3600];
+        gm.total[metric].Record(elapsed);
+        gm.window[metric].Record(elapsed);
+        hour.total[metric].Record(elapsed);
+        hour.window[metric].Record(elapsed);
+    }
+
+    void TicketStats::OnCreated(uint32_t ticketId, uint64_t createTime)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Track(ticketId, createTime);
+    }
+
+    void TicketStats::OnAssigned(uint32_t ticketId, uint64_t createTime, std::string_view gmName, uint64_t now)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        OpenTicket& ticket = Track(ticketId, createTime);
+        if (ticket.assigned)
+            return;
+
+        ticket.assigned = true;
+        Record(METRIC_ASSIGN, ticket.createTime, gmName, now);
+    }
+
+    void TicketStats::OnResponded(uint32_t ticketId, uint64_t createTime, std::string_view gmName, uint64_t now)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        OpenTicket& ticket = Track(ticketId, createTime);
+        if (ticket.responded)
+            return;
+
+        ticket.responded = true;
+        Record(METRIC_FIRST_RESPONSE, ticket.createTime, gmName, now);
+    }
+
+    void TicketStats::OnClosed(uint32_t ticketId, uint64_t createTime, std::string_view gmName, uint64_t now)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        uint64_t created = Track(ticketId, createTime).createTime;
+        _open.erase(ticketId);
+        Record(METRIC_CLOSE, created, gmName, now);
+    }
+
+    void TicketStats::FlushRollup(uint64_t now)
+    {
+        std::string values;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            uint64_t windowStart = _windowStart ? _windowStart : now;
+            _windowStart = now;
+
+            auto append = [&](char const* scope, std::string const& key, Series& series)
+            {
+                for (uint8_t metric = 0; metric < MAX_METRICS; ++metric)
+                {
+                    DurationHistogram& histogram = series.window[metric];
+                    if (!histogram.GetCount())
+                        continue;
+
+                    if (!values.empty())
+                        values += ',';
+                    values += Acore::StringFormat("(FROM_UNIXTIME({}), FROM_UNIXTIME({}), '{}', '{}', '{}', {}, {}, {}, {}, {})",
+                        windowStart, now, scope, EscapeSql(key), METRIC_NAMES[metric], histogram.GetCount(),
+                        histogram.GetPercentile(0.5), histogram.GetPercentile(0.9), histogram.GetPercentile(0.99), histogram.GetMax());
+                    histogram.Reset();
+                }
+            };
+
+            for (auto& [gmName, series] : _byGm)
+                append("gm", gmName, series);
+            for (uint32_t hour = 0; hour < _byHour.size(); ++hour)
+                append("hour", Acore::StringFormat("{:02}", hour), _byHour[hour]);
+        }
+
+        if (values.empty())
+            return;
+
+        SpillQueue::Instance().Execute(
+            "INSERT INTO gm_discord_ticket_stats (period_start, period_end, scope, scope_key, metric, samples, "
+            "p50_seconds, p90_seconds, p99_seconds, max_seconds) VALUES " + values, true);
+    }
+
+    std::string TicketStats::Render() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::vector<std::pair<std::string const*, Series const*>> gms;
+        gms.reserve(_byGm.size());
+        for (auto const& [gmName, series] : _byGm)
+            gms.emplace_back(&gmName, &series);
+
+        auto samples = [](Series const& series) { return series.total[METRIC_CLOSE].GetCount() + series.total[METRIC_FIRST_RESPONSE].GetCount(); };
+        std::sort(gms.begin(), gms.end(), [&](auto const& a, auto const& b) { return samples(*a.second) > samples(*b.second); });
+        if (gms.size() > RENDER_MAX_GMS)
+            gms.resize(RENDER_MAX_GMS);
+
+        std::string out = Acore::StringFormat("Open tickets tracked: {}\nSince startup, p50/p90:\n", _open.size());
+        out += Acore::StringFormat("{:<14} {:>11} {:>11} {:>11}\n", "GM", "response", "assign", "close");
+        for (auto const& [gmName, series] : gms)
+        {
+            out += Acore::StringFormat("{:<14.14} {:>11} {:>11} {:>11}\n", *gmName,
+                FormatPercentiles(series->total[METRIC_FIRST_RESPONSE]), FormatPercentiles(series->total[METRIC_ASSIGN]),
+                FormatPercentiles(series->total[METRIC_CLOSE]));
+        }
+
+        out += "\nFirst response p50 by hour created (UTC):\n";
+        for (uint32_t hour = 0; hour < _byHour.size(); ++hour)
+        {
+            DurationHistogram const& histogram = _byHour[hour].total[METRIC_FIRST_RESPONSE];
+            out += Acore::StringFormat("{:02} {:>6}{}", hour,
+                histogram.GetCount() ? FormatDuration(histogram.GetPercentile(0.5)) : "-", hour % 6 == 5 ? "\n" : "  ");
+        }
+
+        return out;
+    }
+}
@@ -0,0 +1,112 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_TICKET_STATS_H
+#define MOD_GM_DISCORD_TICKET_STATS_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace GMDiscord
+{
+    // Log-linear histogram of durations: exact below 16 units, then eight
+    // sub-buckets per power of two, so any percentile is within ~12%. Ticket
+    // SLAs record seconds, world update diffs milliseconds. Fixed size and
+    // allocation free; merging is element-wise addition.
+    class DurationHistogram
+    {
+    public:
+        static constexpr uint32_t BUCKETS = 16 + 28 * 8;
+
+        void Record(uint64_t value);
+        void Merge(DurationHistogram const& other);
+        void Reset() { *this = DurationHistogram(); }
+
+        uint64_t GetCount() const { return _count; }
+        uint64_t GetMax() const { return _max; }
+        // Upper bound of the bucket holding the q-th quantile (0..1).
+        uint64_t GetPercentile(double q) const;
+
+    private:
+        static uint32_t BucketFor(uint64_t value);
+        static uint64_t UpperBound(uint32_t bucket);
+
+        std::array<uint32_t, BUCKETS> _buckets = { };
+        uint64_t _count = 0;
+        uint64_t _max = 0;
+    };
+
+    // Ticket SLA tracking fed from the ticket hooks and inbox actions on the
+    // world thread. Each metric is kept per GM and per hour of day (of the
+    // ticket's creation) both since startup and for the current rollup
+    // window, which FlushRollup() persists to gm_discord_ticket_stats.
+    class TicketStats
+    {
+    public:
+        enum Metric : uint8_t
+        {
+            METRIC_FIRST_RESPONSE,
+            METRIC_ASSIGN,
+            METRIC_CLOSE,
+            MAX_METRICS
+        };
+
+        static TicketStats& Instance();
+
+        void OnCreated(uint32_t ticketId, uint64_t createTime);
+        void OnAssigned(uint32_t ticketId, uint64_t createTime, std::string_view gmName, uint64_t now);
+        void OnResponded(uint32_t ticketId, uint64_t createTime, std::string_view gmName, uint64_t now);
+        void OnClosed(uint32_t ticketId, uint64_t createTime, std::string_view gmName, uint64_t now);
+
+        // Writes the window's histograms as one multi-row insert and resets them.
+        void FlushRollup(uint64_t now);
+
+        // Compact text report for `/gm-stats tickets`.
+        std::string Render() const;
+
+    private:
+        struct OpenTicket
+        {
+            uint64_t createTime = 0;
+            bool assigned = false;
+            bool responded = false;
+        };
+
+        struct Series
+        {
+            std::array<DurationHistogram, MAX_METRICS> total;
+            std::array<DurationHistogram, MAX_METRICS> window;
+        };
+
+        TicketStats() = default;
+
+        OpenTicket& Track(uint32_t ticketId, uint64_t createTime);
+        void Record(Metric metric, uint64_t createTime, std::string_view gmName, uint64_t now);
+
+        mutable std::mutex _mutex;
+        std::unordered_map<uint32_t, OpenTicket> _open;
+        std::unordered_map<std::string, Series> _byGm;
+        std::array<Series, 24> _byHour;
+        uint64_t _windowStart = 0;
+    };
+}
+
+#endif
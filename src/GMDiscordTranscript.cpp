@@ -0,0 +1,117 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GMDiscordTranscript.h"
+#include "GMDiscordDatabase.h"
+
+#include "DatabaseEnv.h"
+#include "Database/Field.h"
+#include "Database/QueryResult.h"
+#include "Log.h"
+#include "StringFormat.h"
+
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <zlib.h>
+
+namespace GMDiscord
+{
+    std::vector<TranscriptLine> LoadTicketEvents(uint32_t ticketId)
+    {
+        std::vector<TranscriptLine> lines;
+        QueryResult result = ModuleDB().Query(Acore::StringFormat(
+            "SELECT event_type, payload, UNIX_TIMESTAMP(created_at) FROM gm_discord_outbox WHERE ticket_id={} ORDER BY id ASC",
+            ticketId));
+        if (!result)
+            return lines;
+
+        lines.reserve(result->GetRowCount());
+        do
+        {
+            Field* fields = result->Fetch();
+            TranscriptLine line;
+            line.at = fields[2].Get<uint64_t>();
+            // Payloads are JSON built by the world side; embed them verbatim.
+            line.json = Acore::StringFormat(R"({{"at":{},"source":"outbox","event":"{}","data":{}}})",
+                line.at, fields[0].Get<std::string_view>(), fields[1].Get<std::string_view>());
+            lines.push_back(std::move(line));
+        } while (result->NextRow());
+
+        return lines;
+    }
+
+    std::string WriteTranscript(std::string const& directory, uint32_t ticketId, std::vector<TranscriptLine> lines)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec)
+        {
+            LOG_WARN("module.gm_discord", "Cannot create transcript directory '{}': {}", directory, ec.message());
+            return {};
+        }
+
+        // Outbox rows are already in id order; stable keeps them that way
+        // when a thread message shares their second.
+        std::stable_sort(lines.begin(), lines.end(), [](TranscriptLine const& a, TranscriptLine const& b)
+        {
+            return a.at < b.at;
+        });
+
+        uint64_t now = static_cast<uint64_t>(std::time(nullptr));
+        std::string path = (std::filesystem::path(directory) / Acore::StringFormat("ticket-{}-{}.jsonl.gz", ticketId, now)).string();
+        gzFile file = gzopen(path.c_str(), "wb");
+        if (!file)
+        {
+            LOG_WARN("module.gm_discord", "Cannot open transcript file '{}'.", path);
+            return {};
+        }
+
+        bool ok = true;
+        auto writeLine = [&](std::string const& json)
+        {
+            ok = ok && gzwrite(file, json.data(), static_cast<unsigned>(json.size())) == static_cast<int>(json.size())
+                && gzputc(file, '\n') == '\n';
+        };
+
+        writeLine(Acore::StringFormat(R"({{"ticketId":{},"exportedAt":{},"lines":{}}})", ticketId, now, lines.size()));
+        for (TranscriptLine const& line : lines)
+            writeLine(line.json);
+
+        if (gzclose(file) != Z_OK || !ok)
+        {
+            LOG_WARN("module.gm_discord", "Failed to write transcript '{}'.", path);
+            std::filesystem::remove(path, ec);
+            return {};
+        }
+
+        return path;
+    }
+
+    bool ReadTranscriptFile(std::string const& path, std::string& contents)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            return false;
+
+        contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return true;
+    }
+}
@@ -0,0 +1,47 @@
+/*
+ * This file is part of the AzerothCore Project. See AUTHORS file for Copyright information
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MOD_GM_DISCORD_TRANSCRIPT_H
+#define MOD_GM_DISCORD_TRANSCRIPT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace GMDiscord
+{
+    // One JSONL record of a ticket transcript. `at` (unix seconds) orders
+    // outbox events against the thread messages fetched from Discord.
+    struct TranscriptLine
+    {
+        uint64_t at = 0;
+        std::string json;
+    };
+
+    // Every outbox event recorded for the ticket, oldest first. Reads only
+    // the ticket's rows through idx_ticket_id.
+    std::vector<TranscriptLine> LoadTicketEvents(uint32_t ticketId);
+
+    // Streams the lines, ordered by time, into
+    // `directory/ticket-<id>-<unix time>.jsonl.gz`. Returns the path written,
+    // or an empty string on failure.
+    std::string WriteTranscript(std::string const& directory, uint32_t ticketId, std::vector<TranscriptLine> lines);
+
+    bool ReadTranscriptFile(std::string const& path, std::string& contents);
+}
+
+#endif
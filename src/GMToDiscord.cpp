@@ -23,7 +23,20 @@
 #include "CommandScript.h"
 #include "Config.h"
 #include "DatabaseEnv.h"
+#include "GMDiscordAlerts.h"
+#include "GMDiscordAssign.h"
 #include "GMDiscordBot.h"
+#include "GMDiscordConversation.h"
+#include "GMDiscordDatabase.h"
+#include "GMDiscordEscalation.h"
+#include "GMDiscordInbox.h"
+#include "GMDiscordKeywords.h"
+#include "GMDiscordLogRelay.h"
+#include "GMDiscordMetrics.h"
+#include "GMDiscordPresence.h"
+#include "GMDiscordSettings.h"
+#include "GMDiscordSpill.h"
+#include "GMDiscordTicketStats.h"
 #include "GameTime.h"
 #include "Log.h"
 #include "Mail.h"
@@ -34,10 +47,19 @@
 #include "TicketMgr.h"
 #include "World.h"
 #include "WorldPacket.h"
+#include "WorldSessionMgr.h"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <charconv>
+#include <cstddef>
 #include <deque>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <set>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -47,6 +69,102 @@ using namespace Acore::ChatCommands;
 
 namespace GMDiscord
 {
+	// Text with {id}, {player}, {gm} and {reason} placeholders, split into
+	// segments once at config load so rendering is a straight append.
+	class MessageTemplate
+	{
+	public:
+		enum Field : uint8
+		{
+			FIELD_NONE,
+			FIELD_ID,
+			FIELD_PLAYER,
+			FIELD_GM,
+			FIELD_REASON
+		};
+
+		struct Values
+		{
+			uint32 id = 0;
+			std::string_view player;
+			std::string_view gm;
+			std::string_view reason;
+		};
+
+		MessageTemplate() = default;
+
+		// A literal "\n" in the config value becomes a line break.
+		explicit MessageTemplate(std::string_view text)
+		{
+			std::string literal;
+			for (size_t i = 0; i < text.size(); ++i)
+			{
+				if (text[i] == '\\' && i + 1 < text.size() && text[i + 1] == 'n')
+				{
+					literal += '\n';
+					++i;
+					continue;
+				}
+
+				Field field = FIELD_NONE;
+				size_t length = 0;
+				if (text[i] == '{')
+				{
+					std::string_view rest = text.substr(i);
+					for (auto const& [token, tokenField] : { std::pair<std::string_view, Field>("{id}", FIELD_ID),
+						{ "{player}", FIELD_PLAYER }, { "{gm}", FIELD_GM }, { "{reason}", FIELD_REASON } })
+					{
+						if (rest.substr(0, token.size()) == token)
+						{
+							field = tokenField;
+							length = token.size();
+							break;
+						}
+					}
+				}
+
+				if (field == FIELD_NONE)
+				{
+					literal += text[i];
+					continue;
+				}
+
+				_segments.push_back({ std::move(literal), field });
+				literal.clear();
+				i += length - 1;
+			}
+
+			if (!literal.empty())
+				_segments.push_back({ std::move(literal), FIELD_NONE });
+		}
+
+		template <typename String>
+		void Render(String& out, Values const& values) const
+		{
+			for (Segment const& segment : _segments)
+			{
+				out.append(segment.literal);
+				switch (segment.field)
+				{
+					case FIELD_ID: fmt::format_to(std::back_inserter(out), "{}", values.id); break;
+					case FIELD_PLAYER: out.append(values.player); break;
+					case FIELD_GM: out.append(values.gm); break;
+					case FIELD_REASON: out.append(values.reason); break;
+					default: break;
+				}
+			}
+		}
+
+	private:
+		struct Segment
+		{
+			std::string literal;
+			Field field = FIELD_NONE;
+		};
+
+		std::vector<Segment> _segments;
+	};
+
 	struct Settings
 	{
 		bool enabled = true;
@@ -55,7 +173,12 @@ namespace GMDiscord
 		bool allowAllCommands = false;
 		bool rateLimitEnabled = true;
 		uint32 pollIntervalMs = 1000;
+		bool pollAdaptive = true;
+		uint32 pollMinIntervalMs = 100;
+		uint32 pollMaxIntervalMs = 1000;
 		uint32 maxBatchSize = 25;
+		std::array<uint32, MAX_INBOX_LANES> laneWeight = { 4, 2, 1 };
+		std::array<uint32, MAX_INBOX_LANES> laneQuota = { 25, 10, 10 };
 		uint32 minSecurity = SEC_GAMEMASTER;
 		uint32 linkCodeTtlSeconds = 900;
 		uint32 secretTtlSeconds = 900;
@@ -66,14 +189,48 @@ namespace GMDiscord
 		uint32 auditPayloadMax = 1024;
 		std::string ticketCreateWhisperMessage;
 		std::string ticketCreateWhisperSender;
+		bool ticketCloseMailEnabled = true;
+		uint32 statsRollupIntervalMs = 300000;
+		uint32 statusIntervalMs = 60000;
+		bool escalationEnabled = false;
+		uint32 escalationAfterSeconds = 1800;
+		MessageTemplate ticketCloseMailSubject;
+		MessageTemplate ticketCloseMailBody;
 		std::vector<std::string> commandAllowList;
-		std::unordered_map<std::string, uint32> categoryMinSecurity;
+		std::map<std::string, uint32, std::less<>> categoryRequiredSecurity;
 	};
 
-	static Settings g_Settings;
+	static SettingsSnapshot<Settings> g_Settings;
 	static std::unordered_map<uint64, std::deque<uint64>> g_RateLimiter;
+	// Inbox ids of commands handed to the world CLI queue and not yet finished.
+	static std::set<uint32> g_PendingCommands;
+	// Deficit round robin credit carried between polls, per inbox lane.
+	static std::array<uint32, MAX_INBOX_LANES> g_LaneDeficit = { };
 
-	static std::string Trim(std::string_view value)
+	static Settings const& GetSettings()
+	{
+		return g_Settings.Get();
+	}
+
+	// Scratch memory for one inbox batch. Strings built while handling a row
+	// (lowered actions, escaped SQL, formatted statements) come from a stack
+	// buffer and are released together when the batch ends.
+	class BatchArena
+	{
+	public:
+		BatchArena() : _resource(_buffer.data(), _buffer.size()) { }
+
+		BatchArena(BatchArena const&) = delete;
+		BatchArena& operator=(BatchArena const&) = delete;
+
+		std::pmr::memory_resource* Resource() { return &_resource; }
+
+	private:
+		alignas(std::max_align_t) std::array<std::byte, 32 * 1024> _buffer;
+		std::pmr::monotonic_buffer_resource _resource;
+	};
+
+	static std::string_view TrimView(std::string_view value)
 	{
 		size_t start = 0;
 		while (start < value.size() && std::isspace(static_cast<unsigned char>(value[start])))
@@ -83,7 +240,35 @@ namespace GMDiscord
 		while (end > start && std::isspace(static_cast<unsigned char>(value[end - 1])))
 			--end;
 
-		return std::string(value.substr(start, end - start));
+		return value.substr(start, end - start);
+	}
+
+	static std::string Trim(std::string_view value)
+	{
+		return std::string(TrimView(value));
+	}
+
+	static bool EqualsNoCase(std::string_view left, std::string_view right)
+	{
+		return left.size() == right.size() && std::equal(left.begin(), left.end(), right.begin(),
+			[](char a, char b) { return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b)); });
+	}
+
+	static bool StartsWithNoCase(std::string_view text, std::string_view prefix)
+	{
+		return text.size() >= prefix.size() && EqualsNoCase(text.substr(0, prefix.size()), prefix);
+	}
+
+	template <typename... Args>
+	static void FormatTo(std::pmr::string& out, fmt::format_string<Args...> format, Args&&... args)
+	{
+		fmt::format_to(std::back_inserter(out), format, std::forward<Args>(args)...);
+	}
+
+	static bool ParseUInt(std::string_view text, uint32& out)
+	{
+		auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), out);
+		return ec == std::errc() && ptr == text.data() + text.size();
 	}
 
 	static std::string ToLower(std::string_view value)
@@ -138,45 +323,69 @@ namespace GMDiscord
 		return out;
 	}
 
-	static std::string EscapeSql(std::string const& input)
+	static std::string EscapeSql(std::string_view input)
 	{
-		std::string escaped = input;
+		std::string escaped(input);
 		CharacterDatabase.EscapeString(escaped);
 		return escaped;
 	}
 
 	static void LoadSettings()
 	{
-		g_Settings.enabled = sConfigMgr->GetOption<bool>("GMDiscord.Enable", true);
-		g_Settings.outboxEnabled = sConfigMgr->GetOption<bool>("GMDiscord.Outbox.Enable", true);
-		g_Settings.whisperEnabled = sConfigMgr->GetOption<bool>("GMDiscord.Whisper.Enable", true);
-		g_Settings.allowAllCommands = sConfigMgr->GetOption<bool>("GMDiscord.CommandAllowAll", false);
-		g_Settings.rateLimitEnabled = sConfigMgr->GetOption<bool>("GMDiscord.RateLimit.Enable", true);
-		g_Settings.pollIntervalMs = sConfigMgr->GetOption<uint32>("GMDiscord.PollIntervalMs", 1000);
-		g_Settings.maxBatchSize = sConfigMgr->GetOption<uint32>("GMDiscord.MaxBatchSize", 25);
-		g_Settings.minSecurity = sConfigMgr->GetOption<uint32>("GMDiscord.MinSecurityLevel", SEC_GAMEMASTER);
-		g_Settings.linkCodeTtlSeconds = sConfigMgr->GetOption<uint32>("GMDiscord.LinkCodeTtlSeconds", 900);
-		g_Settings.secretTtlSeconds = sConfigMgr->GetOption<uint32>("GMDiscord.SecretTtlSeconds", 900);
-		g_Settings.maxResultLength = sConfigMgr->GetOption<uint32>("GMDiscord.MaxResultLength", 4000);
-		g_Settings.rateLimitWindowSeconds = sConfigMgr->GetOption<uint32>("GMDiscord.RateLimit.WindowSeconds", 10);
-		g_Settings.rateLimitMaxActions = sConfigMgr->GetOption<uint32>("GMDiscord.RateLimit.MaxActions", 5);
-		g_Settings.rateLimitMinIntervalMs = sConfigMgr->GetOption<uint32>("GMDiscord.RateLimit.MinIntervalMs", 500);
-		g_Settings.auditPayloadMax = sConfigMgr->GetOption<uint32>("GMDiscord.Audit.PayloadMax", 1024);
-		g_Settings.ticketCreateWhisperMessage = sConfigMgr->GetOption<std::string>(
+		auto settings = std::make_unique<Settings>();
+		settings->enabled = sConfigMgr->GetOption<bool>("GMDiscord.Enable", true);
+		settings->outboxEnabled = sConfigMgr->GetOption<bool>("GMDiscord.Outbox.Enable", true);
+		settings->whisperEnabled = sConfigMgr->GetOption<bool>("GMDiscord.Whisper.Enable", true);
+		settings->allowAllCommands = sConfigMgr->GetOption<bool>("GMDiscord.CommandAllowAll", false);
+		settings->rateLimitEnabled = sConfigMgr->GetOption<bool>("GMDiscord.RateLimit.Enable", true);
+		settings->pollIntervalMs = sConfigMgr->GetOption<uint32>("GMDiscord.PollIntervalMs", 1000);
+		settings->pollAdaptive = sConfigMgr->GetOption<bool>("GMDiscord.Poll.Adaptive", true);
+		settings->pollMinIntervalMs = std::max<uint32>(1, sConfigMgr->GetOption<uint32>("GMDiscord.Poll.MinIntervalMs", 100));
+		settings->pollMaxIntervalMs = std::max(settings->pollMinIntervalMs,
+			sConfigMgr->GetOption<uint32>("GMDiscord.Poll.MaxIntervalMs", settings->pollIntervalMs));
+		settings->maxBatchSize = sConfigMgr->GetOption<uint32>("GMDiscord.MaxBatchSize", 25);
+		for (uint8 lane = 0; lane < MAX_INBOX_LANES; ++lane)
+		{
+			std::string laneKey = GetInboxLaneName(lane);
+			laneKey[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(laneKey[0])));
+			settings->laneWeight[lane] = std::max<uint32>(1, sConfigMgr->GetOption<uint32>(
+				Acore::StringFormat("GMDiscord.Inbox.{}.Weight", laneKey), settings->laneWeight[lane]));
+			settings->laneQuota[lane] = sConfigMgr->GetOption<uint32>(
+				Acore::StringFormat("GMDiscord.Inbox.{}.Quota", laneKey), settings->laneQuota[lane]);
+		}
+		settings->minSecurity = sConfigMgr->GetOption<uint32>("GMDiscord.MinSecurityLevel", SEC_GAMEMASTER);
+		settings->linkCodeTtlSeconds = sConfigMgr->GetOption<uint32>("GMDiscord.LinkCodeTtlSeconds", 900);
+		settings->secretTtlSeconds = sConfigMgr->GetOption<uint32>("GMDiscord.SecretTtlSeconds", 900);
+		settings->maxResultLength = sConfigMgr->GetOption<uint32>("GMDiscord.MaxResultLength", 4000);
+		settings->rateLimitWindowSeconds = sConfigMgr->GetOption<uint32>("GMDiscord.RateLimit.WindowSeconds", 10);
+		settings->rateLimitMaxActions = sConfigMgr->GetOption<uint32>("GMDiscord.RateLimit.MaxActions", 5);
+		settings->rateLimitMinIntervalMs = sConfigMgr->GetOption<uint32>("GMDiscord.RateLimit.MinIntervalMs", 500);
+		settings->auditPayloadMax = sConfigMgr->GetOption<uint32>("GMDiscord.Audit.PayloadMax", 1024);
+		settings->ticketCreateWhisperMessage = sConfigMgr->GetOption<std::string>(
 			"GMDiscord.Ticket.CreateWhisperMessage",
 			"Thank you for your ticket. A GM will contact you soon.");
-		g_Settings.ticketCreateWhisperSender = sConfigMgr->GetOption<std::string>(
+		settings->ticketCreateWhisperSender = sConfigMgr->GetOption<std::string>(
 			"GMDiscord.Ticket.CreateWhisperSender",
 			"Customer Support");
+		settings->ticketCloseMailEnabled = sConfigMgr->GetOption<bool>("GMDiscord.Ticket.CloseMail.Enable", true);
+		settings->statsRollupIntervalMs = sConfigMgr->GetOption<uint32>("GMDiscord.Stats.RollupIntervalSeconds", 300) * 1000;
+		settings->statusIntervalMs = sConfigMgr->GetOption<uint32>("GMDiscord.Status.IntervalSeconds", 60) * 1000;
+		settings->escalationEnabled = sConfigMgr->GetOption<bool>("GMDiscord.Escalation.Enable", false);
+		settings->escalationAfterSeconds = sConfigMgr->GetOption<uint32>("GMDiscord.Escalation.AfterMinutes", 30) * 60;
+		settings->ticketCloseMailSubject = MessageTemplate(sConfigMgr->GetOption<std::string>(
+			"GMDiscord.Ticket.CloseMail.Subject", "Ticket Closed"));
+		settings->ticketCloseMailBody = MessageTemplate(sConfigMgr->GetOption<std::string>(
+			"GMDiscord.Ticket.CloseMail.Body", "Your ticket #{id} has been closed.\\n\\nReason:\\n{reason}"));
 
 		std::string allowList = sConfigMgr->GetOption<std::string>("GMDiscord.CommandAllowList", ".ticket;.gm");
-		g_Settings.commandAllowList = SplitAllowList(allowList);
+		settings->commandAllowList = SplitAllowList(allowList);
 
-		g_Settings.categoryMinSecurity.clear();
+		// Stored as the effective requirement so checks need no max() per action.
 		auto setCategory = [&](std::string const& name, uint32 def)
 		{
-			g_Settings.categoryMinSecurity[name] = sConfigMgr->GetOption<uint32>(
+			uint32 categoryMin = sConfigMgr->GetOption<uint32>(
 				Acore::StringFormat("GMDiscord.CommandCategory.{}.MinSecurity", name), def);
+			settings->categoryRequiredSecurity[name] = std::max(settings->minSecurity, categoryMin);
 		};
 		setCategory("ticket", SEC_GAMEMASTER);
 		setCategory("tele", SEC_GAMEMASTER);
@@ -189,94 +398,97 @@ namespace GMDiscord
 		setCategory("debug", SEC_ADMINISTRATOR);
 		setCategory("whisper", SEC_GAMEMASTER);
 		setCategory("misc", SEC_GAMEMASTER);
+
+		AutoAssigner::Instance().SetRequiredSecurity(settings->categoryRequiredSecurity["ticket"]);
+		KeywordMatcher::Instance().LoadConfig();
+		g_Settings.Publish(std::move(settings));
 	}
 
-	static bool IsCommandAllowed(std::string_view command)
+	static bool IsCommandAllowed(Settings const& settings, std::string_view command)
 	{
-		if (g_Settings.allowAllCommands)
+		if (settings.allowAllCommands)
 			return true;
 
-		std::string trimmed = ToLower(Trim(command));
+		// Allow list entries are stored lowercased.
+		std::string_view trimmed = TrimView(command);
 		if (trimmed.empty())
 			return false;
 
-		for (std::string const& prefix : g_Settings.commandAllowList)
+		for (std::string const& prefix : settings.commandAllowList)
 		{
-			if (!prefix.empty() && trimmed.rfind(prefix, 0) == 0)
+			if (!prefix.empty() && StartsWithNoCase(trimmed, prefix))
 				return true;
 		}
 
 		return false;
 	}
 
-	static std::string GetCommandRoot(std::string_view command)
+	static std::string_view GetCommandRoot(std::string_view command)
 	{
-		std::string trimmed = Trim(command);
+		std::string_view trimmed = TrimView(command);
 		if (trimmed.empty())
 			return {};
 
 		if (trimmed.front() == '.' || trimmed.front() == '!')
-			trimmed.erase(trimmed.begin());
+			trimmed.remove_prefix(1);
 
-		trimmed = Trim(trimmed);
+		trimmed = TrimView(trimmed);
 		if (trimmed.empty())
 			return {};
 
-		size_t space = trimmed.find(' ');
-		std::string root = (space == std::string::npos) ? trimmed : trimmed.substr(0, space);
-		return ToLower(root);
+		return trimmed.substr(0, trimmed.find(' '));
 	}
 
-	static std::string GetCommandCategory(std::string_view root)
+	static std::string_view GetCommandCategory(std::string_view root)
 	{
-		std::string token = ToLower(root);
-		if (token == "ticket" || token == "tickets")
+		auto is = [root](std::string_view token) { return EqualsNoCase(root, token); };
+		if (is("ticket") || is("tickets"))
 			return "ticket";
-		if (token == "tele" || token == "teleport" || token == "go")
+		if (is("tele") || is("teleport") || is("go"))
 			return "tele";
-		if (token == "gm" || token == "gminfo" || token == "gmname")
+		if (is("gm") || is("gminfo") || is("gmname"))
 			return "gm";
-		if (token == "ban" || token == "unban")
+		if (is("ban") || is("unban"))
 			return "ban";
-		if (token == "account" || token == "acc")
+		if (is("account") || is("acc"))
 			return "account";
-		if (token == "character" || token == "char")
+		if (is("character") || is("char"))
 			return "character";
-		if (token == "lookup" || token == "who" || token == "name")
+		if (is("lookup") || is("who") || is("name"))
 			return "lookup";
-		if (token == "server" || token == "shutdown" || token == "restart")
+		if (is("server") || is("shutdown") || is("restart"))
 			return "server";
-		if (token == "debug")
+		if (is("debug"))
 			return "debug";
 		return "misc";
 	}
 
-	static uint32 GetCategoryMinSecurity(std::string const& category)
+	static uint32 GetRequiredSecurity(Settings const& settings, std::string_view category)
 	{
-		auto it = g_Settings.categoryMinSecurity.find(category);
-		if (it != g_Settings.categoryMinSecurity.end())
+		auto it = settings.categoryRequiredSecurity.find(category);
+		if (it != settings.categoryRequiredSecurity.end())
 			return it->second;
-		return g_Settings.minSecurity;
+		return settings.minSecurity;
 	}
 
-	static bool CheckRateLimit(uint64 discordUserId, std::string const& action, std::string& reason)
+	static bool CheckRateLimit(Settings const& settings, uint64 discordUserId, std::string_view action, std::string& reason)
 	{
-		if (!g_Settings.rateLimitEnabled)
+		if (!settings.rateLimitEnabled)
 			return true;
 
 		uint64 nowMs = GameTime::GetGameTimeMS().count();
-		uint64 windowMs = uint64(g_Settings.rateLimitWindowSeconds) * 1000;
+		uint64 windowMs = uint64(settings.rateLimitWindowSeconds) * 1000;
 		auto& bucket = g_RateLimiter[discordUserId];
 		while (!bucket.empty() && nowMs - bucket.front() > windowMs)
 			bucket.pop_front();
 
-		if (!bucket.empty() && g_Settings.rateLimitMinIntervalMs > 0 && nowMs - bucket.back() < g_Settings.rateLimitMinIntervalMs)
+		if (!bucket.empty() && settings.rateLimitMinIntervalMs > 0 && nowMs - bucket.back() < settings.rateLimitMinIntervalMs)
 		{
-			reason = Acore::StringFormat("Rate limit for {}: wait {} ms", action, g_Settings.rateLimitMinIntervalMs);
+			reason = Acore::StringFormat("Rate limit for {}: wait {} ms", action, settings.rateLimitMinIntervalMs);
 			return false;
 		}
 
-		if (g_Settings.rateLimitMaxActions > 0 && bucket.size() >= g_Settings.rateLimitMaxActions)
+		if (settings.rateLimitMaxActions > 0 && bucket.size() >= settings.rateLimitMaxActions)
 		{
 			reason = Acore::StringFormat("Rate limit exceeded for {}", action);
 			return false;
@@ -286,124 +498,108 @@ namespace GMDiscord
 		return true;
 	}
 
-	static std::string TruncateAuditPayload(std::string const& payload)
+	static std::string_view TruncateAuditPayload(std::string_view payload)
 	{
-		if (g_Settings.auditPayloadMax == 0 || payload.size() <= g_Settings.auditPayloadMax)
+		Settings const& settings = GetSettings();
+		if (settings.auditPayloadMax == 0 || payload.size() <= settings.auditPayloadMax)
 			return payload;
-		return payload.substr(0, g_Settings.auditPayloadMax);
+		return payload.substr(0, settings.auditPayloadMax);
 	}
 
-	static void LogAudit(uint64 discordUserId, uint32 accountId, std::string const& action, std::string const& category,
-		std::string const& status, std::string const& detail, std::string const& payload)
+	static void LogAudit(uint64 discordUserId, uint32 accountId, std::string_view action, std::string_view category,
+		std::string_view status, std::string_view detail, std::string_view payload,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource())
 	{
-		std::string actionEsc = EscapeSql(action);
-		std::string categoryEsc = EscapeSql(category);
-		std::string statusEsc = EscapeSql(status);
-		std::string detailEsc = EscapeSql(detail);
-		std::string payloadEsc = EscapeSql(TruncateAuditPayload(payload));
-		CharacterDatabase.Execute(Acore::StringFormat(
+		std::pmr::string sql(resource);
+		FormatTo(sql,
 			"INSERT INTO gm_discord_audit (discord_user_id, account_id, action, category, status, detail, payload) "
 			"VALUES ({}, {}, '{}', '{}', '{}', '{}', '{}')",
-			discordUserId, accountId, actionEsc, categoryEsc, statusEsc, detailEsc, payloadEsc));
+			discordUserId, accountId, EscapeSql(action), EscapeSql(category), EscapeSql(status),
+			EscapeSql(detail), EscapeSql(TruncateAuditPayload(payload)));
+		SpillQueue::Instance().Execute(sql, true);
 	}
 
-	static void EnqueueOutbox(std::string const& eventType, std::string const& payload)
+	// ticketId ties the event to a ticket so the close transcript can read
+	// back just that ticket's rows through idx_ticket_id.
+	static void EnqueueOutbox(std::string const& eventType, std::string const& payload, uint32 ticketId = 0)
 	{
-		if (!g_Settings.enabled || !g_Settings.outboxEnabled)
+		Settings const& settings = GetSettings();
+		if (!settings.enabled || !settings.outboxEnabled)
 			return;
 
 		std::string eventEsc = EscapeSql(eventType);
 		std::string payloadEsc = EscapeSql(payload);
-		CharacterDatabase.Execute(Acore::StringFormat(
-			"INSERT INTO gm_discord_outbox (event_type, payload) VALUES ('{}', '{}')",
-			eventEsc, payloadEsc));
+		SpillQueue::Instance().Execute(Acore::StringFormat(
+			"INSERT INTO gm_discord_outbox (event_type, ticket_id, payload) VALUES ('{}', {}, '{}')",
+			eventEsc, ticketId, payloadEsc));
 	}
 
-	static void MarkInboxResult(uint32 id, std::string const& status, std::string const& result)
+	static void MarkInboxResult(uint32 id, std::string_view status, std::string_view result,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource())
 	{
-		std::string statusEsc = EscapeSql(status);
-		std::string resultEsc = EscapeSql(result);
-		CharacterDatabase.Execute(Acore::StringFormat(
+		std::pmr::string sql(resource);
+		FormatTo(sql,
 			"UPDATE gm_discord_inbox SET processed=1, processed_at=NOW(), status='{}', result='{}' WHERE id={}",
-			statusEsc, resultEsc, id));
+			EscapeSql(status), EscapeSql(result), id);
+		ModuleDB().Execute(sql);
 	}
 
 	static void MarkInboxProcessing(uint32 id)
 	{
-		CharacterDatabase.Execute(Acore::StringFormat(
+		ModuleDB().Execute(Acore::StringFormat(
 			"UPDATE gm_discord_inbox SET processed=2 WHERE id={} AND processed=0",
 			id));
 	}
 
-	static bool ParseWhisperPayload(std::string const& payload, std::string& playerName, std::string& gmName, std::string& message)
+	// Parsers return views into the inbox row; they stay valid for the batch.
+	static bool ParseWhisperPayload(std::string_view payload, std::string_view& playerName, std::string_view& gmName, std::string_view& message)
 	{
 		size_t first = payload.find('|');
-		if (first == std::string::npos)
+		if (first == std::string_view::npos)
 			return false;
 		size_t second = payload.find('|', first + 1);
-		if (second == std::string::npos)
+		if (second == std::string_view::npos)
 			return false;
 
-		playerName = payload.substr(0, first);
-		gmName = payload.substr(first + 1, second - first - 1);
-		message = payload.substr(second + 1);
-		playerName = Trim(playerName);
-		gmName = Trim(gmName);
-		message = Trim(message);
+		playerName = TrimView(payload.substr(0, first));
+		gmName = TrimView(payload.substr(first + 1, second - first - 1));
+		message = TrimView(payload.substr(second + 1));
 		return !playerName.empty() && !gmName.empty() && !message.empty();
 	}
 
-	static bool ParseTicketAssignPayload(std::string const& payload, uint32& ticketId, std::string& gmName)
+	static bool ParseTicketAssignPayload(std::string_view payload, uint32& ticketId, std::string_view& gmName)
 	{
 		size_t sep = payload.find('|');
-		if (sep == std::string::npos)
+		if (sep == std::string_view::npos)
 			return false;
 
-		std::string idStr = Trim(payload.substr(0, sep));
-		gmName = Trim(payload.substr(sep + 1));
+		std::string_view idStr = TrimView(payload.substr(0, sep));
+		gmName = TrimView(payload.substr(sep + 1));
 		if (idStr.empty() || gmName.empty())
 			return false;
 
-		try
-		{
-			ticketId = static_cast<uint32>(std::stoul(idStr));
-		}
-		catch (...)
-		{
-			return false;
-		}
-
-		return ticketId > 0;
+		return ParseUInt(idStr, ticketId) && ticketId > 0;
 	}
 
-	static bool ParseTicketClosePayload(std::string const& payload, uint32& ticketId, std::string& gmName, std::string& reason)
+	static bool ParseTicketClosePayload(std::string_view payload, uint32& ticketId, std::string_view& gmName, std::string_view& reason)
 	{
 		size_t first = payload.find('|');
-		if (first == std::string::npos)
+		if (first == std::string_view::npos)
 			return false;
 		size_t second = payload.find('|', first + 1);
-		if (second == std::string::npos)
+		if (second == std::string_view::npos)
 			return false;
 
-		std::string idStr = Trim(payload.substr(0, first));
-		gmName = Trim(payload.substr(first + 1, second - first - 1));
-		reason = Trim(payload.substr(second + 1));
+		std::string_view idStr = TrimView(payload.substr(0, first));
+		gmName = TrimView(payload.substr(first + 1, second - first - 1));
+		reason = TrimView(payload.substr(second + 1));
 		if (idStr.empty() || gmName.empty() || reason.empty())
 			return false;
 
-		try
-		{
-			ticketId = static_cast<uint32>(std::stoul(idStr));
-		}
-		catch (...)
-		{
-			return false;
-		}
-
-		return ticketId > 0;
+		return ParseUInt(idStr, ticketId) && ticketId > 0;
 	}
 
-	static void SendWhisperToPlayer(Player* player, std::string const& gmName, std::string const& message)
+	static void SendWhisperToPlayer(Player* player, std::string const& gmName, std::string_view message)
 	{
 		if (!player || !player->GetSession())
 			return;
@@ -426,22 +622,24 @@ namespace GMDiscord
 		player->GetSession()->SendPacket(&data);
 	}
 
-	static void UpsertWhisperSession(Player* player, uint64 discordUserId, std::string const& gmName)
+	static void UpsertWhisperSession(Player* player, uint64 discordUserId, std::string_view gmName,
+		std::pmr::memory_resource* resource = std::pmr::get_default_resource())
 	{
 		if (!player)
 			return;
 
-		std::string gmEsc = EscapeSql(gmName);
-		CharacterDatabase.Execute(Acore::StringFormat(
+		std::pmr::string sql(resource);
+		FormatTo(sql,
 			"REPLACE INTO gm_discord_whisper_session (player_guid, discord_user_id, gm_name, updated_at) "
 			"VALUES ({}, {}, '{}', NOW())",
-			player->GetGUID().GetRawValue(), discordUserId, gmEsc));
+			player->GetGUID().GetRawValue(), discordUserId, EscapeSql(gmName));
+		ModuleDB().Execute(sql);
 	}
 
 	static bool TryGetWhisperSession(std::string const& gmName, uint64& discordUserId)
 	{
 		std::string gmEsc = EscapeSql(gmName);
-		QueryResult result = CharacterDatabase.Query(Acore::StringFormat(
+		QueryResult result = ModuleDB().Query(Acore::StringFormat(
 			"SELECT discord_user_id FROM gm_discord_whisper_session WHERE LOWER(gm_name) = LOWER('{}') LIMIT 1",
 			gmEsc));
 
@@ -455,7 +653,7 @@ namespace GMDiscord
 	static bool VerifyAndLinkSecret(uint64 discordUserId, std::string const& secret, uint32& outAccountId)
 	{
 		outAccountId = 0;
-		QueryResult result = CharacterDatabase.Query(
+		QueryResult result = ModuleDB().Query(
 			"SELECT account_id, secret_hash FROM gm_discord_link WHERE secret_hash IS NOT NULL AND secret_expires_at > NOW()");
 
 		if (!result)
@@ -471,7 +669,7 @@ namespace GMDiscord
 
 			if (Acore::Crypto::Argon2::Verify(secret, hash))
 			{
-				CharacterDatabase.Execute(Acore::StringFormat(
+				ModuleDB().Execute(Acore::StringFormat(
 					"UPDATE gm_discord_link SET discord_user_id={}, verified=1, secret_hash=NULL, secret_expires_at=NULL, updated_at=NOW() WHERE account_id={} LIMIT 1",
 					discordUserId, accountId));
 				outAccountId = accountId;
@@ -482,19 +680,37 @@ namespace GMDiscord
 		return false;
 	}
 
-	static bool CheckCommandPermissions(std::string_view command, uint32 accountId, std::string& outCategory, std::string& outReason)
+	static void RegisterLinkedGm(uint32 accountId, uint64 discordUserId)
+	{
+		QueryResult result = ModuleDB().Query(Acore::StringFormat(
+			"SELECT gm_name FROM gm_discord_link WHERE account_id={} AND gm_name IS NOT NULL LIMIT 1",
+			accountId));
+		std::string gmName = result ? (*result)[0].Get<std::string>() : "";
+
+		// Presence first: the assigner asks it whether the GM is reachable.
+		GmPresence::Instance().Register(accountId, discordUserId, gmName);
+		if (AutoAssigner::Instance().IsEnabled() && !gmName.empty())
+			AutoAssigner::Instance().RegisterGm(accountId, gmName, AccountMgr::GetSecurity(accountId));
+	}
+
+	// First GM response to a ticket, from any source.
+	static void NoteTicketResponse(GmTicket* ticket, std::string_view gmName)
 	{
-		if (!IsCommandAllowed(command))
+		TicketStats::Instance().OnResponded(ticket->GetId(), ticket->GetCreateTime(), gmName, GameTime::GetGameTime().count());
+		EscalationTimers::Instance().Cancel(ticket->GetId());
+	}
+
+	static bool CheckCommandPermissions(Settings const& settings, std::string_view command, uint32 accountId, std::string_view& outCategory, std::string& outReason)
+	{
+		if (!IsCommandAllowed(settings, command))
 		{
 			outReason = "Command not allowed by GMDiscord.CommandAllowList";
 			return false;
 		}
 
-		std::string root = GetCommandRoot(command);
-		outCategory = GetCommandCategory(root);
+		outCategory = GetCommandCategory(GetCommandRoot(command));
 		uint32 security = AccountMgr::GetSecurity(accountId);
-		uint32 categoryMin = GetCategoryMinSecurity(outCategory);
-		uint32 required = std::max(g_Settings.minSecurity, categoryMin);
+		uint32 required = GetRequiredSecurity(settings, outCategory);
 
 		if (security < required)
 		{
@@ -513,7 +729,15 @@ namespace GMDiscord
 		std::string output;
 
 		explicit CommandContext(uint32 commandId, uint64 discordId, uint32 accId)
-			: id(commandId), discordUserId(discordId), accountId(accId) { }
+			: id(commandId), discordUserId(discordId), accountId(accId)
+		{
+			g_PendingCommands.insert(id);
+		}
+
+		~CommandContext()
+		{
+			g_PendingCommands.erase(id);
+		}
 
 		static void Print(void* arg, std::string_view text)
 		{
@@ -524,10 +748,11 @@ namespace GMDiscord
 			if (!ctx)
 				return;
 
-			if (ctx->output.size() >= g_Settings.maxResultLength)
+			uint32 maxResultLength = GetSettings().maxResultLength;
+			if (ctx->output.size() >= maxResultLength)
 				return;
 
-			size_t remaining = g_Settings.maxResultLength - ctx->output.size();
+			size_t remaining = maxResultLength - ctx->output.size();
 			ctx->output.append(text.substr(0, remaining));
 		}
 
@@ -554,16 +779,17 @@ namespace GMDiscord
 		}
 	};
 
-	static void QueueCommand(uint32 inboxId, uint64 discordUserId, uint32 accountId, std::string const& command)
+	// The holder copies the command text, so arena-backed strings are fine here.
+	static void QueueCommand(uint32 inboxId, uint64 discordUserId, uint32 accountId, char const* command)
 	{
 		CommandContext* ctx = new CommandContext(inboxId, discordUserId, accountId);
-		CliCommandHolder* cmd = new CliCommandHolder(ctx, command.c_str(), &CommandContext::Print, &CommandContext::Finished);
+		CliCommandHolder* cmd = new CliCommandHolder(ctx, command, &CommandContext::Print, &CommandContext::Finished);
 		sWorld->QueueCliCommand(cmd);
 	}
 
 	static bool GetLinkedAccount(uint64 discordUserId, uint32& accountId, bool& verified)
 	{
-		QueryResult result = CharacterDatabase.Query(Acore::StringFormat(
+		QueryResult result = ModuleDB().Query(Acore::StringFormat(
 			"SELECT account_id, verified FROM gm_discord_link WHERE discord_user_id={} LIMIT 1",
 			discordUserId));
 
@@ -576,31 +802,251 @@ namespace GMDiscord
 		return true;
 	}
 
-	static void ProcessInbox()
+	struct InboxRow
+	{
+		uint32 id = 0;
+		uint64 discordUserId = 0;
+		std::string_view action;
+		std::string_view payload;
+	};
+
+	// Picks up to MaxBatchSize rows across lanes with deficit round robin:
+	// each round a lane earns its weight in credit and spends one credit per
+	// row, bounded by its per-poll quota. Credit of a lane that runs dry is
+	// dropped so an idle lane can't bank a burst.
+	static void ScheduleInboxRows(Settings const& settings, std::array<std::pmr::vector<InboxRow>, MAX_INBOX_LANES> const& lanes,
+		std::pmr::vector<InboxRow const*>& order)
+	{
+		std::array<size_t, MAX_INBOX_LANES> next = { };
+		while (order.size() < settings.maxBatchSize)
+		{
+			bool progressed = false;
+			for (uint8 lane = 0; lane < MAX_INBOX_LANES; ++lane)
+			{
+				uint32 quota = settings.laneQuota[lane] ? settings.laneQuota[lane] : settings.maxBatchSize;
+				if (next[lane] >= lanes[lane].size() || next[lane] >= quota)
+				{
+					if (next[lane] >= lanes[lane].size())
+						g_LaneDeficit[lane] = 0;
+					continue;
+				}
+
+				g_LaneDeficit[lane] += settings.laneWeight[lane];
+				while (g_LaneDeficit[lane] > 0 && next[lane] < lanes[lane].size() && next[lane] < quota &&
+					order.size() < settings.maxBatchSize)
+				{
+					order.push_back(&lanes[lane][next[lane]++]);
+					--g_LaneDeficit[lane];
+					progressed = true;
+				}
+			}
+
+			if (!progressed)
+				break;
+		}
+	}
+
+	struct InboxPollResult
+	{
+		uint32 processed = 0;
+		bool backlog = false;
+	};
+
+	struct InboxMetrics
+	{
+		std::atomic<uint64>& polls = Metrics::Instance().Get("inbox.polls");
+		std::atomic<uint64>& emptyPolls = Metrics::Instance().Get("inbox.polls_empty");
+		std::atomic<uint64>& emptyRatio = Metrics::Instance().Get("inbox.empty_poll_ratio_permille");
+		std::atomic<uint64>& intervalMs = Metrics::Instance().Get("inbox.poll_interval_ms");
+		std::atomic<uint64>& rows = Metrics::Instance().Get("inbox.rows_processed");
+		std::atomic<uint64>& backlog = Metrics::Instance().Get("inbox.backlog");
+	};
+
+	static InboxMetrics& GetInboxMetrics()
+	{
+		static InboxMetrics metrics;
+		return metrics;
+	}
+
+	// Empty-poll ratio is a moving average over roughly the last 32 polls.
+	static void RecordInboxPoll(InboxPollResult const& poll, uint32 nextIntervalMs)
 	{
-		if (!g_Settings.enabled)
+		InboxMetrics& metrics = GetInboxMetrics();
+		bool empty = poll.processed == 0;
+		metrics.polls.fetch_add(1, std::memory_order_relaxed);
+		if (empty)
+			metrics.emptyPolls.fetch_add(1, std::memory_order_relaxed);
+		metrics.rows.fetch_add(poll.processed, std::memory_order_relaxed);
+
+		uint64 ratio = metrics.emptyRatio.load(std::memory_order_relaxed);
+		metrics.emptyRatio.store((ratio * 31 + (empty ? 1000 : 0)) / 32, std::memory_order_relaxed);
+		metrics.intervalMs.store(nextIntervalMs, std::memory_order_relaxed);
+		metrics.backlog.store(poll.backlog ? 1 : 0, std::memory_order_relaxed);
+	}
+
+	struct WorldStatusMetrics
+	{
+		std::atomic<uint64>& players = Metrics::Instance().Get("world.players");
+		std::atomic<uint64>& queuedSessions = Metrics::Instance().Get("world.queued_sessions");
+		std::atomic<uint64>& openTickets = Metrics::Instance().Get("world.open_tickets");
+		std::atomic<uint64>& updateDiffP50 = Metrics::Instance().Get("world.update_diff_p50_ms");
+		std::atomic<uint64>& updateDiffP99 = Metrics::Instance().Get("world.update_diff_p99_ms");
+		std::atomic<uint64>& startTime = Metrics::Instance().Get("world.start_time");
+		std::atomic<uint64>& dbQueue = Metrics::Instance().Get("db.character_queue");
+		std::atomic<uint64>& spillPending = Metrics::Instance().Get("spill.pending");
+	};
+
+	// Copies counters the core already keeps into gauges for the bot's
+	// status embed. `updateDiffs` holds the world update diffs (ms) since
+	// the previous sample and is reset here.
+	static void SampleWorldStatus(DurationHistogram& updateDiffs)
+	{
+		static WorldStatusMetrics metrics;
+		metrics.players.store(sWorldSessionMgr->GetPlayerCount(), std::memory_order_relaxed);
+		metrics.queuedSessions.store(sWorldSessionMgr->GetQueuedSessionCount(), std::memory_order_relaxed);
+		metrics.openTickets.store(sTicketMgr->GetOpenTicketCount(), std::memory_order_relaxed);
+		metrics.startTime.store(GameTime::GetGameTime().count() - GameTime::GetUptime().count(), std::memory_order_relaxed);
+		metrics.dbQueue.store(CharacterDatabase.QueueSize(), std::memory_order_relaxed);
+		metrics.spillPending.store(SpillQueue::Instance().GetPendingCount(), std::memory_order_relaxed);
+		if (updateDiffs.GetCount())
+		{
+			metrics.updateDiffP50.store(updateDiffs.GetPercentile(0.50), std::memory_order_relaxed);
+			metrics.updateDiffP99.store(updateDiffs.GetPercentile(0.99), std::memory_order_relaxed);
+		}
+		updateDiffs.Reset();
+	}
+
+	// Work or a backlog pins the poller to its fast interval; every empty
+	// poll doubles it up to the configured ceiling.
+	static uint32 NextPollInterval(Settings const& settings, uint32 currentMs, InboxPollResult const& poll)
+	{
+		if (!settings.pollAdaptive)
+			return settings.pollIntervalMs;
+
+		if (poll.processed || poll.backlog)
+			return settings.pollMinIntervalMs;
+
+		uint64 next = std::max<uint64>(uint64(currentMs) * 2, settings.pollMinIntervalMs);
+		return static_cast<uint32>(std::min<uint64>(next, settings.pollMaxIntervalMs));
+	}
+
+	struct PendingCloseMail
+	{
+		uint32 ticketId = 0;
+		std::pmr::string playerName;
+		std::string_view gmName;
+		std::string_view reason;
+	};
+
+	// Sends every close mail of one batch in a single transaction. Player
+	// GUIDs are looked up once per distinct name.
+	static void SendTicketCloseMails(Settings const& settings, std::pmr::vector<PendingCloseMail> const& mails,
+		std::pmr::memory_resource* resource)
+	{
+		if (mails.empty())
 			return;
 
-		QueryResult result = CharacterDatabase.Query(Acore::StringFormat(
-			"SELECT id, discord_user_id, action, payload FROM gm_discord_inbox WHERE processed=0 ORDER BY id ASC LIMIT {}",
-			g_Settings.maxBatchSize));
+		std::pmr::unordered_map<std::string_view, ObjectGuid> guids(resource);
+		CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
+		uint32 sent = 0;
+		for (PendingCloseMail const& mail : mails)
+		{
+			auto [it, inserted] = guids.try_emplace(mail.playerName);
+			if (inserted)
+				it->second = sCharacterCache->GetCharacterGuidByName(std::string(mail.playerName));
 
+			ObjectGuid playerGuid = it->second;
+			if (!playerGuid)
+				continue;
+
+			MessageTemplate::Values values;
+			values.id = mail.ticketId;
+			values.player = mail.playerName;
+			values.gm = mail.gmName;
+			values.reason = mail.reason;
+
+			std::string subject;
+			std::string body;
+			settings.ticketCloseMailSubject.Render(subject, values);
+			settings.ticketCloseMailBody.Render(body, values);
+			MailDraft(subject, body).SendMailTo(trans, MailReceiver(playerGuid.GetCounter()),
+				MailSender(MAIL_NORMAL, playerGuid.GetCounter(), MAIL_STATIONERY_GM));
+			++sent;
+		}
+
+		if (sent)
+			CharacterDatabase.CommitTransaction(trans);
+	}
+
+	static InboxPollResult ProcessInbox()
+	{
+		// One snapshot per batch so a reload never splits a batch across settings.
+		Settings const& settings = GetSettings();
+		if (!settings.enabled)
+			return {};
+
+		// Results would be spilled anyway; don't block the world thread on a sick DB.
+		if (SpillQueue::Instance().IsDegraded())
+			return {};
+
+		// One indexed range scan per lane, each capped at what the lane could
+		// be granted this poll.
+		std::string query;
+		for (uint8 lane = 0; lane < MAX_INBOX_LANES; ++lane)
+		{
+			uint32 quota = settings.laneQuota[lane] ? std::min(settings.laneQuota[lane], settings.maxBatchSize) : settings.maxBatchSize;
+			if (!query.empty())
+				query += " UNION ALL ";
+			query += Acore::StringFormat(
+				"(SELECT id, discord_user_id, action, payload, lane FROM gm_discord_inbox WHERE processed=0 AND lane={} ORDER BY id ASC LIMIT {})",
+				lane, quota);
+		}
+
+		QueryResult result = ModuleDB().Query(query);
 		if (!result)
-			return;
+			return {};
 
+		// Released in one go when the batch returns.
+		BatchArena arena;
+		std::pmr::memory_resource* resource = arena.Resource();
+
+		// Views into the result set, which outlives the batch.
+		std::array<std::pmr::vector<InboxRow>, MAX_INBOX_LANES> lanes = {
+			std::pmr::vector<InboxRow>(resource), std::pmr::vector<InboxRow>(resource), std::pmr::vector<InboxRow>(resource) };
 		do
 		{
 			Field* fields = result->Fetch();
-			uint32 id = fields[0].Get<uint32>();
-			uint64 discordUserId = fields[1].Get<uint64>();
-			std::string action = ToLower(fields[2].Get<std::string>());
-			std::string payload = fields[3].Get<std::string>();
+			uint8 lane = fields[4].Get<uint8>();
+			if (lane >= MAX_INBOX_LANES)
+				lane = INBOX_LANE_BULK;
+			lanes[lane].push_back({ fields[0].Get<uint32>(), fields[1].Get<uint64>(),
+				fields[2].Get<std::string_view>(), fields[3].Get<std::string_view>() });
+		} while (result->NextRow());
+
+		std::pmr::vector<InboxRow const*> order(resource);
+		order.reserve(settings.maxBatchSize);
+		ScheduleInboxRows(settings, lanes, order);
+
+		std::pmr::vector<PendingCloseMail> closeMails(resource);
+
+		InboxPollResult poll;
+		poll.processed = static_cast<uint32>(order.size());
+		poll.backlog = result->GetRowCount() > order.size() || order.size() >= settings.maxBatchSize;
+
+		for (InboxRow const* row : order)
+		{
+			uint32 id = row->id;
+			uint64 discordUserId = row->discordUserId;
+			std::string_view payload = row->payload;
+
+			std::pmr::string action(row->action, resource);
+			std::transform(action.begin(), action.end(), action.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
 
 			std::string rateReason;
-			if (!CheckRateLimit(discordUserId, action, rateReason))
+			if (!CheckRateLimit(settings, discordUserId, action, rateReason))
 			{
-				MarkInboxResult(id, "rate_limited", rateReason);
-				LogAudit(discordUserId, 0, action, action, "rate_limited", rateReason, payload);
+				MarkInboxResult(id, "rate_limited", rateReason, resource);
+				LogAudit(discordUserId, 0, action, action, "rate_limited", rateReason, payload, resource);
 				continue;
 			}
 
@@ -610,57 +1056,58 @@ namespace GMDiscord
 				bool verified = false;
 				if (!GetLinkedAccount(discordUserId, accountId, verified))
 				{
-					MarkInboxResult(id, "not_linked", "Discord user is not linked to a GM account");
-					LogAudit(discordUserId, accountId, action, "command", "not_linked", "Discord user is not linked", payload);
+					MarkInboxResult(id, "not_linked", "Discord user is not linked to a GM account", resource);
+					LogAudit(discordUserId, accountId, action, "command", "not_linked", "Discord user is not linked", payload, resource);
 					continue;
 				}
 
 				if (!verified)
 				{
-					MarkInboxResult(id, "not_verified", "Discord user is not verified");
-					LogAudit(discordUserId, accountId, action, "command", "not_verified", "Discord user is not verified", payload);
+					MarkInboxResult(id, "not_verified", "Discord user is not verified", resource);
+					LogAudit(discordUserId, accountId, action, "command", "not_verified", "Discord user is not verified", payload, resource);
 					continue;
 				}
 
-				std::string category;
+				std::string_view category;
 				std::string reason;
-				if (!CheckCommandPermissions(payload, accountId, category, reason))
+				if (!CheckCommandPermissions(settings, payload, accountId, category, reason))
 				{
-					MarkInboxResult(id, "forbidden", reason);
-					LogAudit(discordUserId, accountId, action, category.empty() ? "command" : category, "forbidden", reason, payload);
+					MarkInboxResult(id, "forbidden", reason, resource);
+					LogAudit(discordUserId, accountId, action, category.empty() ? "command" : category, "forbidden", reason, payload, resource);
 					continue;
 				}
 
 				MarkInboxProcessing(id);
-				QueueCommand(id, discordUserId, accountId, payload);
-				LogAudit(discordUserId, accountId, action, category, "queued", "Command queued", payload);
+				QueueCommand(id, discordUserId, accountId, std::pmr::string(payload, resource).c_str());
+				LogAudit(discordUserId, accountId, action, category, "queued", "Command queued", payload, resource);
 			}
 			else if (action == "auth")
 			{
 				if (payload.empty())
 				{
-					MarkInboxResult(id, "invalid", "Missing secret payload");
-					LogAudit(discordUserId, 0, action, "auth", "invalid", "Missing secret payload", payload);
+					MarkInboxResult(id, "invalid", "Missing secret payload", resource);
+					LogAudit(discordUserId, 0, action, "auth", "invalid", "Missing secret payload", payload, resource);
 					continue;
 				}
 
 				uint32 linkedAccountId = 0;
-				if (!VerifyAndLinkSecret(discordUserId, payload, linkedAccountId))
+				if (!VerifyAndLinkSecret(discordUserId, std::string(payload), linkedAccountId))
 				{
-					MarkInboxResult(id, "invalid", "Secret not found or expired");
-					LogAudit(discordUserId, 0, action, "auth", "invalid", "Secret not found or expired", payload);
+					MarkInboxResult(id, "invalid", "Secret not found or expired", resource);
+					LogAudit(discordUserId, 0, action, "auth", "invalid", "Secret not found or expired", payload, resource);
 					continue;
 				}
 
-				MarkInboxResult(id, "ok", "Discord user linked successfully");
-				LogAudit(discordUserId, linkedAccountId, action, "auth", "ok", "Discord user linked successfully", payload);
+				MarkInboxResult(id, "ok", "Discord user linked successfully", resource);
+				LogAudit(discordUserId, linkedAccountId, action, "auth", "ok", "Discord user linked successfully", payload, resource);
+				RegisterLinkedGm(linkedAccountId, discordUserId);
 			}
 			else if (action == "whisper")
 			{
-				if (!g_Settings.whisperEnabled)
+				if (!settings.whisperEnabled)
 				{
-					MarkInboxResult(id, "disabled", "Whisper relay disabled");
-					LogAudit(discordUserId, 0, action, "whisper", "disabled", "Whisper relay disabled", payload);
+					MarkInboxResult(id, "disabled", "Whisper relay disabled", resource);
+					LogAudit(discordUserId, 0, action, "whisper", "disabled", "Whisper relay disabled", payload, resource);
 					continue;
 				}
 
@@ -668,46 +1115,60 @@ namespace GMDiscord
 				bool verified = false;
 				if (!GetLinkedAccount(discordUserId, accountId, verified) || !verified)
 				{
-					MarkInboxResult(id, "not_verified", "Discord user is not verified");
-					LogAudit(discordUserId, accountId, action, "whisper", "not_verified", "Discord user is not verified", payload);
+					MarkInboxResult(id, "not_verified", "Discord user is not verified", resource);
+					LogAudit(discordUserId, accountId, action, "whisper", "not_verified", "Discord user is not verified", payload, resource);
 					continue;
 				}
 
 				uint32 security = AccountMgr::GetSecurity(accountId);
-				uint32 required = std::max(g_Settings.minSecurity, GetCategoryMinSecurity("whisper"));
+				uint32 required = GetRequiredSecurity(settings, "whisper");
 				if (security < required)
 				{
-					MarkInboxResult(id, "forbidden", "Account security is too low");
-					LogAudit(discordUserId, accountId, action, "whisper", "forbidden", "Account security is too low", payload);
+					MarkInboxResult(id, "forbidden", "Account security is too low", resource);
+					LogAudit(discordUserId, accountId, action, "whisper", "forbidden", "Account security is too low", payload, resource);
 					continue;
 				}
 
-				std::string playerName;
-				std::string gmName;
-				std::string message;
-				if (!ParseWhisperPayload(payload, playerName, gmName, message))
+				std::string_view playerName;
+				std::string_view gmNameView;
+				std::string_view message;
+				if (!ParseWhisperPayload(payload, playerName, gmNameView, message))
 				{
-					MarkInboxResult(id, "invalid", "Invalid whisper payload");
-					LogAudit(discordUserId, accountId, action, "whisper", "invalid", "Invalid whisper payload", payload);
+					MarkInboxResult(id, "invalid", "Invalid whisper payload", resource);
+					LogAudit(discordUserId, accountId, action, "whisper", "invalid", "Invalid whisper payload", payload, resource);
 					continue;
 				}
 
-				Player* player = ObjectAccessor::FindPlayerByName(playerName, false);
+				Player* player = ObjectAccessor::FindPlayerByName(std::string(playerName), false);
 				if (!player)
 				{
-					MarkInboxResult(id, "player_offline", "Player is offline");
-					LogAudit(discordUserId, accountId, action, "whisper", "player_offline", "Player is offline", payload);
+					MarkInboxResult(id, "player_offline", "Player is offline", resource);
+					LogAudit(discordUserId, accountId, action, "whisper", "player_offline", "Player is offline", payload, resource);
 					continue;
 				}
 
+				std::string gmName(gmNameView);
 				SendWhisperToPlayer(player, gmName, message);
-				UpsertWhisperSession(player, discordUserId, gmName);
-				MarkInboxResult(id, "ok", "Whisper delivered");
-				LogAudit(discordUserId, accountId, action, "whisper", "ok", "Whisper delivered", payload);
+				UpsertWhisperSession(player, discordUserId, gmName, resource);
+				MarkInboxResult(id, "ok", "Whisper delivered", resource);
+				LogAudit(discordUserId, accountId, action, "whisper", "ok", "Whisper delivered", payload, resource);
 
-				uint32 ticketId = 0;
 				if (GmTicket* ticket = sTicketMgr->GetTicketByPlayer(player->GetGUID()))
-					ticketId = ticket->GetId();
+				{
+					NoteTicketResponse(ticket, gmName);
+					ConversationBuffer::Instance().Append(ticket->GetId(), false, gmName, message, GameTime::GetGameTime().count());
+
+					// Not posted anywhere; recorded so the close transcript has both sides.
+					EnqueueOutbox("gm_whisper", Acore::StringFormat(
+						R"({{"event":"gm_whisper","whisper":{{"player":"{}","playerGuid":{},"gmName":"{}","discordUserId":{},"ticketId":{},"message":"{}"}},"timestamp":{}}})",
+						EscapeJson(player->GetName()),
+						player->GetGUID().GetRawValue(),
+						EscapeJson(gmName),
+						discordUserId,
+						ticket->GetId(),
+						EscapeJson(message),
+						GameTime::GetGameTime().count()), ticket->GetId());
+				}
 			}
 			else if (action == "ticket_assign")
 			{
@@ -715,33 +1176,34 @@ namespace GMDiscord
 				bool verified = false;
 				if (!GetLinkedAccount(discordUserId, accountId, verified) || !verified)
 				{
-					MarkInboxResult(id, "not_verified", "Discord user is not verified");
-					LogAudit(discordUserId, accountId, action, "ticket", "not_verified", "Discord user is not verified", payload);
+					MarkInboxResult(id, "not_verified", "Discord user is not verified", resource);
+					LogAudit(discordUserId, accountId, action, "ticket", "not_verified", "Discord user is not verified", payload, resource);
 					continue;
 				}
 
-				std::string category;
+				std::string_view category;
 				std::string reason;
-				if (!CheckCommandPermissions(".ticket assign", accountId, category, reason))
+				if (!CheckCommandPermissions(settings, ".ticket assign", accountId, category, reason))
 				{
-					MarkInboxResult(id, "forbidden", reason);
-					LogAudit(discordUserId, accountId, action, "ticket", "forbidden", reason, payload);
+					MarkInboxResult(id, "forbidden", reason, resource);
+					LogAudit(discordUserId, accountId, action, "ticket", "forbidden", reason, payload, resource);
 					continue;
 				}
 
 				uint32 ticketId = 0;
-				std::string gmName;
+				std::string_view gmName;
 				if (!ParseTicketAssignPayload(payload, ticketId, gmName))
 				{
-					MarkInboxResult(id, "invalid", "Invalid ticket assignment payload");
-					LogAudit(discordUserId, accountId, action, "ticket", "invalid", "Invalid ticket assignment payload", payload);
+					MarkInboxResult(id, "invalid", "Invalid ticket assignment payload", resource);
+					LogAudit(discordUserId, accountId, action, "ticket", "invalid", "Invalid ticket assignment payload", payload, resource);
 					continue;
 				}
 
-				std::string command = Acore::StringFormat(".ticket assign {} {}", ticketId, gmName);
+				std::pmr::string command(resource);
+				FormatTo(command, ".ticket assign {} {}", ticketId, gmName);
 				MarkInboxProcessing(id);
-				QueueCommand(id, discordUserId, accountId, command);
-				LogAudit(discordUserId, accountId, action, "ticket", "queued", "Ticket assignment queued", payload);
+				QueueCommand(id, discordUserId, accountId, command.c_str());
+				LogAudit(discordUserId, accountId, action, "ticket", "queued", "Ticket assignment queued", payload, resource);
 			}
 			else if (action == "ticket_close")
 			{
@@ -749,62 +1211,130 @@ namespace GMDiscord
 				bool verified = false;
 				if (!GetLinkedAccount(discordUserId, accountId, verified) || !verified)
 				{
-					MarkInboxResult(id, "not_verified", "Discord user is not verified");
-					LogAudit(discordUserId, accountId, action, "ticket", "not_verified", "Discord user is not verified", payload);
+					MarkInboxResult(id, "not_verified", "Discord user is not verified", resource);
+					LogAudit(discordUserId, accountId, action, "ticket", "not_verified", "Discord user is not verified", payload, resource);
 					continue;
 				}
 
 				uint32 security = AccountMgr::GetSecurity(accountId);
-				uint32 required = std::max(g_Settings.minSecurity, GetCategoryMinSecurity("ticket"));
+				uint32 required = GetRequiredSecurity(settings, "ticket");
 				if (security < required)
 				{
-					MarkInboxResult(id, "forbidden", "Account security is too low");
-					LogAudit(discordUserId, accountId, action, "ticket", "forbidden", "Account security is too low", payload);
+					MarkInboxResult(id, "forbidden", "Account security is too low", resource);
+					LogAudit(discordUserId, accountId, action, "ticket", "forbidden", "Account security is too low", payload, resource);
 					continue;
 				}
 
 				uint32 ticketId = 0;
-				std::string gmName;
-				std::string reason;
+				std::string_view gmName;
+				std::string_view reason;
 				if (!ParseTicketClosePayload(payload, ticketId, gmName, reason))
 				{
-					MarkInboxResult(id, "invalid", "Invalid ticket close payload");
-					LogAudit(discordUserId, accountId, action, "ticket", "invalid", "Invalid ticket close payload", payload);
+					MarkInboxResult(id, "invalid", "Invalid ticket close payload", resource);
+					LogAudit(discordUserId, accountId, action, "ticket", "invalid", "Invalid ticket close payload", payload, resource);
 					continue;
 				}
 
 				GmTicket* ticket = sTicketMgr->GetTicket(ticketId);
 				if (!ticket)
 				{
-					MarkInboxResult(id, "not_found", "Ticket not found");
-					LogAudit(discordUserId, accountId, action, "ticket", "not_found", "Ticket not found", payload);
+					MarkInboxResult(id, "not_found", "Ticket not found", resource);
+					LogAudit(discordUserId, accountId, action, "ticket", "not_found", "Ticket not found", payload, resource);
 					continue;
 				}
 
-				ObjectGuid playerGuid = sCharacterCache->GetCharacterGuidByName(ticket->GetPlayerName());
-				if (playerGuid)
-				{
-					CharacterDatabaseTransaction trans = CharacterDatabase.BeginTransaction();
-					std::string subject = "Ticket Closed";
-					std::string body = Acore::StringFormat("Your ticket #{} has been closed.\n\nReason:\n{}", ticketId, reason);
-				MailDraft(subject, body).SendMailTo(trans, MailReceiver(playerGuid.GetCounter()),
-					MailSender(MAIL_NORMAL, playerGuid.GetCounter(), MAIL_STATIONERY_GM));
-					CharacterDatabase.CommitTransaction(trans);
-				}
+				if (settings.ticketCloseMailEnabled)
+					closeMails.push_back({ ticketId, std::pmr::string(ticket->GetPlayerName(), resource), gmName, reason });
 
-				std::string command = Acore::StringFormat(".ticket close {}", ticketId);
+				std::pmr::string command(resource);
+				FormatTo(command, ".ticket close {}", ticketId);
 				MarkInboxProcessing(id);
-				QueueCommand(id, discordUserId, accountId, command);
-				LogAudit(discordUserId, accountId, action, "ticket", "queued", "Ticket close queued", payload);
+				QueueCommand(id, discordUserId, accountId, command.c_str());
+				LogAudit(discordUserId, accountId, action, "ticket", "queued", "Ticket close queued", payload, resource);
 			}
 			else
 			{
-				MarkInboxResult(id, "invalid", "Unknown action");
-				LogAudit(discordUserId, 0, action, action, "invalid", "Unknown action", payload);
+				MarkInboxResult(id, "invalid", "Unknown action", resource);
+				LogAudit(discordUserId, 0, action, action, "invalid", "Unknown action", payload, resource);
 			}
+		}
+
+		SendTicketCloseMails(settings, closeMails, resource);
+		return poll;
+	}
+
+	// Assignment and a first response are picked up from whichever ticket
+	// hook sees them first; TicketStats ignores repeats.
+	static void TrackTicketProgress(GmTicket* ticket)
+	{
+		if (!ticket)
+			return;
+
+		uint64 now = GameTime::GetGameTime().count();
+		std::string assignedTo = ticket->GetAssignedToName();
+		if (ticket->IsAssigned())
+		{
+			TicketStats::Instance().OnAssigned(ticket->GetId(), ticket->GetCreateTime(), assignedTo, now);
+			AutoAssigner::Instance().OnTicketAssigned(ticket->GetId(), ticket->GetAssignedToGUID().GetRawValue());
+		}
+		else
+			AutoAssigner::Instance().OnTicketUnassigned(ticket->GetId());
+		if (!ticket->GetResponseText().empty())
+			NoteTicketResponse(ticket, assignedTo);
+	}
+
+	static std::string BuildTicketPayload(GmTicket* ticket, std::string_view eventName);
+
+	// Startup only: open tickets still waiting for a first response get their
+	// deadline back, assigned or not, matching the live path where only a
+	// response or a close cancels. Afterwards deadlines come from the hooks.
+	static void LoadEscalations()
+	{
+		Settings const& settings = GetSettings();
+		if (!settings.enabled || !settings.escalationEnabled)
+			return;
+
+		QueryResult result = ModuleDB().Query(
+			"SELECT id, createTime FROM gm_ticket WHERE type=0 AND response=''");
+		if (!result)
+			return;
+
+		do
+		{
+			Field* fields = result->Fetch();
+			EscalationTimers::Instance().Arm(fields[0].Get<uint32>(), fields[1].Get<uint64>() + settings.escalationAfterSeconds);
 		} while (result->NextRow());
 	}
 
+	static void FireEscalation(uint32 ticketId)
+	{
+		GmTicket* ticket = sTicketMgr->GetTicket(ticketId);
+		if (!ticket || ticket->IsClosed())
+			return;
+
+		LOG_INFO("module.gm_discord", "Ticket #{} has waited past its response deadline; escalating.", ticketId);
+		EnqueueOutbox("ticket_escalation", BuildTicketPayload(ticket, "ticket_escalation"), ticketId);
+	}
+
+	// Assigns a new ticket to the least-loaded reachable GM the same way
+	// `.ticket assign` does, without going through the CLI.
+	static void AutoAssignTicket(GmTicket* ticket)
+	{
+		uint64 gmGuid = 0;
+		uint32 security = 0;
+		if (!ticket || ticket->IsAssigned() || !AutoAssigner::Instance().Pick(gmGuid, security))
+			return;
+
+		ticket->SetAssignedTo(ObjectGuid(gmGuid), AccountMgr::IsAdminAccount(security));
+		CharacterDatabaseTransaction trans = CharacterDatabaseTransaction(nullptr);
+		ticket->SaveToDB(trans);
+		sTicketMgr->UpdateLastChange();
+
+		LOG_INFO("module.gm_discord", "Auto-assigned ticket #{} to {}.", ticket->GetId(), ticket->GetAssignedToName());
+		EnqueueOutbox("ticket_update", BuildTicketPayload(ticket, "ticket_update"), ticket->GetId());
+		TrackTicketProgress(ticket);
+	}
+
 	static std::string BuildTicketPayload(GmTicket* ticket, std::string_view eventName)
 	{
 		if (!ticket)
@@ -814,7 +1344,7 @@ namespace GMDiscord
 		std::string assignedTo = ticket->GetAssignedToName();
 
 	return Acore::StringFormat(
-		R"({{"event":"{}","ticket":{{"id":{},"player":"{}","message":"{}","comment":"{}","response":"{}","assignedTo":"{}","assignedToGuid":{},"status":"{}","escalationStatus":{},"viewed":{},"needResponse":{},"needMoreHelp":{},"createTime":{},"lastModified":{},"closedByGuid":{},"resolvedByGuid":{},"location":{{"mapId":{},"x":{},"y":{},"z":{}}}}}}})",
+		R"({{"event":"{}","ticket":{{"id":{},"player":"{}","message":"{}","comment":"{}","response":"{}","assignedTo":"{}","assignedToGuid":{},"status":"{}","flags":"{}","escalationStatus":{},"viewed":{},"needResponse":{},"needMoreHelp":{},"createTime":{},"lastModified":{},"closedByGuid":{},"resolvedByGuid":{},"location":{{"mapId":{},"x":{},"y":{},"z":{}}}}}}})",
 			eventName,
 			ticket->GetId(),
 			EscapeJson(ticket->GetPlayerName()),
@@ -824,6 +1354,7 @@ namespace GMDiscord
 			EscapeJson(assignedTo),
 			ticket->GetAssignedToGUID().GetRawValue(),
 			status,
+			EscapeJson(KeywordMatcher::Instance().FormatCategories(KeywordMatcher::Instance().Scan(ticket->GetMessage()))),
 			static_cast<uint32>(ticket->GetEscalatedStatus()),
 			ticket->IsViewed() ? 1 : 0,
 			ticket->NeedResponse() ? 1 : 0,
@@ -846,19 +1377,27 @@ public:
 
 	void OnTicketCreate(GmTicket* ticket) override
 	{
-		GMDiscord::EnqueueOutbox("ticket_create", GMDiscord::BuildTicketPayload(ticket, "ticket_create"));
+		GMDiscord::EnqueueOutbox("ticket_create", GMDiscord::BuildTicketPayload(ticket, "ticket_create"),
+			ticket ? ticket->GetId() : 0);
 		if (!ticket)
 			return;
 
-		if (GMDiscord::g_Settings.ticketCreateWhisperMessage.empty())
+		GMDiscord::Settings const& settings = GMDiscord::GetSettings();
+		GMDiscord::TicketStats::Instance().OnCreated(ticket->GetId(), ticket->GetCreateTime());
+		GMDiscord::ConversationBuffer::Instance().Open(ticket->GetId(), ticket->GetPlayerName());
+		if (settings.escalationEnabled)
+			GMDiscord::EscalationTimers::Instance().Arm(ticket->GetId(), ticket->GetCreateTime() + settings.escalationAfterSeconds);
+		GMDiscord::AutoAssignTicket(ticket);
+
+		if (settings.ticketCreateWhisperMessage.empty())
 			return;
 
 		Player* player = ObjectAccessor::FindPlayerByName(ticket->GetPlayerName(), false);
 		if (!player)
 			return;
 
-		GMDiscord::SendSupportWhisperToPlayer(player, GMDiscord::g_Settings.ticketCreateWhisperSender,
-			GMDiscord::g_Settings.ticketCreateWhisperMessage);
+		GMDiscord::SendSupportWhisperToPlayer(player, settings.ticketCreateWhisperSender,
+			settings.ticketCreateWhisperMessage);
 	}
 
 	void OnTicketUpdateLastChange(GmTicket* ticket) override
@@ -866,22 +1405,37 @@ public:
 		if (ticket && ticket->GetCreateTime() == ticket->GetLastModifiedTime())
 			return;
 
-		GMDiscord::EnqueueOutbox("ticket_update", GMDiscord::BuildTicketPayload(ticket, "ticket_update"));
+		GMDiscord::EnqueueOutbox("ticket_update", GMDiscord::BuildTicketPayload(ticket, "ticket_update"),
+			ticket ? ticket->GetId() : 0);
+		GMDiscord::TrackTicketProgress(ticket);
 	}
 
 	void OnTicketClose(GmTicket* ticket) override
 	{
-		GMDiscord::EnqueueOutbox("ticket_close", GMDiscord::BuildTicketPayload(ticket, "ticket_close"));
+		GMDiscord::EnqueueOutbox("ticket_close", GMDiscord::BuildTicketPayload(ticket, "ticket_close"),
+			ticket ? ticket->GetId() : 0);
+		if (!ticket)
+			return;
+
+		GMDiscord::TicketStats::Instance().OnClosed(ticket->GetId(), ticket->GetCreateTime(), ticket->GetAssignedToName(),
+			GameTime::GetGameTime().count());
+		GMDiscord::AutoAssigner::Instance().OnTicketUnassigned(ticket->GetId());
+		GMDiscord::EscalationTimers::Instance().Cancel(ticket->GetId());
+		GMDiscord::ConversationBuffer::Instance().Close(ticket->GetId());
 	}
 
 	void OnTicketStatusUpdate(GmTicket* ticket) override
 	{
-		GMDiscord::EnqueueOutbox("ticket_status", GMDiscord::BuildTicketPayload(ticket, "ticket_status"));
+		GMDiscord::EnqueueOutbox("ticket_status", GMDiscord::BuildTicketPayload(ticket, "ticket_status"),
+			ticket ? ticket->GetId() : 0);
+		GMDiscord::TrackTicketProgress(ticket);
 	}
 
 	void OnTicketResolve(GmTicket* ticket) override
 	{
-		GMDiscord::EnqueueOutbox("ticket_resolve", GMDiscord::BuildTicketPayload(ticket, "ticket_resolve"));
+		GMDiscord::EnqueueOutbox("ticket_resolve", GMDiscord::BuildTicketPayload(ticket, "ticket_resolve"),
+			ticket ? ticket->GetId() : 0);
+		GMDiscord::TrackTicketProgress(ticket);
 	}
 };
 
@@ -890,31 +1444,121 @@ class GMDiscordWorldScript : public WorldScript
 public:
 	GMDiscordWorldScript() : WorldScript("GMDiscordWorldScript") { }
 
-	void OnAfterConfigLoad(bool /*reload*/) override
+	void OnAfterConfigLoad(bool reload) override
 	{
 		GMDiscord::LoadSettings();
+		GMDiscord::SpillQueue::Instance().LoadConfig();
+		GMDiscord::GmPresence::Instance().LoadConfig();
+		GMDiscord::AutoAssigner::Instance().LoadConfig();
+		GMDiscord::ConversationBuffer::Instance().LoadConfig();
+		GMDiscord::AlertPipeline::Instance().LoadConfig();
 		GMDiscord::DiscordBot::Instance().LoadConfig();
+
+		// At startup this happens in OnStartup, once the DB is up.
+		if (reload)
+			GMDiscord::AutoAssigner::Instance().Load();
 	}
 
 	void OnStartup() override
 	{
+		// Before anything below issues its first module query.
+		GMDiscord::ModuleDatabase::Instance().Open();
+		GMDiscord::SpillQueue::Instance().Start();
+		GMDiscord::GmPresence::Instance().Load();
+		GMDiscord::AutoAssigner::Instance().Load();
+		GMDiscord::LoadEscalations();
+		GMDiscord::ConversationBuffer::Instance().Load();
 		GMDiscord::DiscordBot::Instance().Start();
 	}
 
 	void OnShutdown() override
 	{
+		// The world loop has stopped, so queued Discord commands will never run.
+		// Hand their inbox rows back so they are picked up after the restart.
+		if (!GMDiscord::g_PendingCommands.empty())
+		{
+			std::string ids;
+			for (uint32 id : GMDiscord::g_PendingCommands)
+			{
+				if (!ids.empty())
+					ids += ',';
+				ids += std::to_string(id);
+			}
+
+			LOG_INFO("module.gm_discord", "Returning {} queued Discord commands to the inbox for retry after restart.", GMDiscord::g_PendingCommands.size());
+			GMDiscord::SpillQueue::Instance().Execute(Acore::StringFormat(
+				"UPDATE gm_discord_inbox SET processed=0 WHERE processed=2 AND id IN ({})", ids));
+		}
+
+		GMDiscord::TicketStats::Instance().FlushRollup(GameTime::GetGameTime().count());
 		GMDiscord::DiscordBot::Instance().Stop();
+		GMDiscord::SpillQueue::Instance().Stop();
+		GMDiscord::ModuleDatabase::Instance().Close();
 	}
 
 	void OnUpdate(uint32 diff) override
 	{
-		if (!GMDiscord::g_Settings.enabled)
+		GMDiscord::Settings const& settings = GMDiscord::GetSettings();
+		if (!settings.enabled)
 			return;
 
+		if (GMDiscord::ConsumeInboxActivity() && settings.pollAdaptive)
+		{
+			_interval = settings.pollMinIntervalMs;
+			_timer = std::min(_timer, _interval);
+		}
+
+		if (settings.escalationEnabled)
+			GMDiscord::EscalationTimers::Instance().Poll(GameTime::GetGameTime().count(), GMDiscord::FireEscalation);
+
+		if (settings.statsRollupIntervalMs)
+		{
+			if (_rollupTimer <= diff)
+			{
+				_rollupTimer = settings.statsRollupIntervalMs;
+				GMDiscord::TicketStats::Instance().FlushRollup(GameTime::GetGameTime().count());
+			}
+			else
+			{
+				_rollupTimer -= diff;
+			}
+		}
+
+		if (settings.statusIntervalMs)
+		{
+			_updateDiffs.Record(diff);
+			if (_statusTimer <= diff)
+			{
+				_statusTimer = settings.statusIntervalMs;
+				GMDiscord::SampleWorldStatus(_updateDiffs);
+			}
+			else
+			{
+				_statusTimer -= diff;
+			}
+		}
+
+		if (GMDiscord::g_AlertMask.load(std::memory_order_relaxed))
+		{
+			if (_alertTimer <= diff)
+			{
+				GMDiscord::AlertPipeline& alerts = GMDiscord::AlertPipeline::Instance();
+				_alertTimer = alerts.GetFlushIntervalMs();
+				for (std::string const& payload : alerts.Flush(GameTime::GetGameTime().count()))
+					GMDiscord::EnqueueOutbox("alert", payload);
+			}
+			else
+			{
+				_alertTimer -= diff;
+			}
+		}
+
 		if (_timer <= diff)
 		{
-			_timer = GMDiscord::g_Settings.pollIntervalMs;
-			GMDiscord::ProcessInbox();
+			GMDiscord::InboxPollResult poll = GMDiscord::ProcessInbox();
+			_interval = GMDiscord::NextPollInterval(settings, _interval, poll);
+			_timer = _interval;
+			GMDiscord::RecordInboxPoll(poll, _interval);
 		}
 		else
 		{
@@ -924,6 +1568,11 @@ public:
 
 private:
 	uint32 _timer = 0;
+	uint32 _interval = 0;
+	uint32 _rollupTimer = 0;
+	uint32 _statusTimer = 0;
+	uint32 _alertTimer = 0;
+	GMDiscord::DurationHistogram _updateDiffs;
 };
 
 class GMDiscordCommandScript : public CommandScript
@@ -974,22 +1623,23 @@ public:
 			return false;
 		}
 
+		uint32 secretTtlSeconds = GMDiscord::GetSettings().secretTtlSeconds;
 		uint32 accountId = session->GetAccountId();
 		std::string hashEsc = GMDiscord::EscapeSql(*hash);
 		std::string gmNameEsc = GMDiscord::EscapeSql(session->GetPlayer()->GetName());
-		CharacterDatabase.Execute(Acore::StringFormat(
+		GMDiscord::ModuleDB().Execute(Acore::StringFormat(
 			"INSERT INTO gm_discord_link (account_id, discord_user_id, verified, secret_hash, secret_expires_at, gm_name) "
 			"VALUES ({}, NULL, 0, '{}', DATE_ADD(NOW(), INTERVAL {} SECOND), '{}') "
 			"ON DUPLICATE KEY UPDATE discord_user_id=NULL, verified=0, secret_hash='{}', secret_expires_at=DATE_ADD(NOW(), INTERVAL {} SECOND), gm_name='{}', updated_at=NOW()",
 			accountId,
 			hashEsc,
-			GMDiscord::g_Settings.secretTtlSeconds,
+			secretTtlSeconds,
 			gmNameEsc,
 			hashEsc,
-			GMDiscord::g_Settings.secretTtlSeconds,
+			secretTtlSeconds,
 			gmNameEsc));
 
-		handler->PSendSysMessage("Discord link secret set. It expires in {} minutes.", GMDiscord::g_Settings.secretTtlSeconds / 60);
+		handler->PSendSysMessage("Discord link secret set. It expires in {} minutes.", secretTtlSeconds / 60);
 		return true;
 	}
 
@@ -1003,7 +1653,7 @@ public:
 		}
 
 		uint32 accountId = session->GetAccountId();
-		QueryResult result = CharacterDatabase.Query(Acore::StringFormat(
+		QueryResult result = GMDiscord::ModuleDB().Query(Acore::StringFormat(
 			"SELECT discord_user_id, verified, secret_expires_at FROM gm_discord_link WHERE account_id={} LIMIT 1",
 			accountId));
 
@@ -1035,9 +1685,11 @@ public:
 		}
 
 		uint32 accountId = session->GetAccountId();
-		CharacterDatabase.Execute(Acore::StringFormat(
+		GMDiscord::ModuleDB().Execute(Acore::StringFormat(
 			"DELETE FROM gm_discord_link WHERE account_id={} LIMIT 1",
 			accountId));
+		GMDiscord::GmPresence::Instance().Unregister(accountId);
+		GMDiscord::AutoAssigner::Instance().UnregisterAccount(accountId);
 
 		handler->SendSysMessage("Discord link removed.");
 		return true;
@@ -1051,14 +1703,31 @@ public:
 
 	bool OnPlayerWhisper(Player* player, uint32 type, uint32 language, std::string& msg, std::string const& receiverName, Player* receiver) override
 	{
-		if (!GMDiscord::g_Settings.enabled || !GMDiscord::g_Settings.whisperEnabled)
+		// Player-to-player whispers are where gold sellers and scammers work.
+		if (GMDiscord::IsAlertEnabled(GMDiscord::ALERT_KEYWORD_WHISPER) && player && receiver && type == CHAT_MSG_WHISPER)
+			if (uint32 categories = GMDiscord::KeywordMatcher::Instance().Scan(msg))
+				GMDiscord::AlertPipeline::Instance().Push(GMDiscord::ALERT_KEYWORD_WHISPER, player->GetGUID().GetRawValue(), 0,
+					categories, msg);
+
+		GMDiscord::Settings const& settings = GMDiscord::GetSettings();
+		if (!settings.enabled || !settings.whisperEnabled)
 			return true;
 
 		if (!player || type != CHAT_MSG_WHISPER)
 			return true;
 
 		if (receiver)
+		{
+			// An in-game GM whisper to a player with an open ticket counts as a response.
+			if (player->GetSession() && player->GetSession()->GetSecurity() >= SEC_GAMEMASTER)
+				if (GmTicket* ticket = sTicketMgr->GetTicketByPlayer(receiver->GetGUID()))
+				{
+					GMDiscord::NoteTicketResponse(ticket, player->GetName());
+					GMDiscord::ConversationBuffer::Instance().Append(ticket->GetId(), false, player->GetName(), msg,
+						GameTime::GetGameTime().count());
+				}
 			return true;
+		}
 
 		uint64 discordUserId = 0;
 		if (!GMDiscord::TryGetWhisperSession(receiverName, discordUserId))
@@ -1069,26 +1738,96 @@ public:
 			ticketId = ticket->GetId();
 
 		std::string payload = Acore::StringFormat(
-			R"({{"event":"player_whisper","whisper":{{"player":"{}","playerGuid":{},"gmName":"{}","discordUserId":{},"ticketId":{},"message":"{}"}},"timestamp":{}}})",
+			R"({{"event":"player_whisper","whisper":{{"player":"{}","playerGuid":{},"gmName":"{}","discordUserId":{},"ticketId":{},"message":"{}","flags":"{}"}},"timestamp":{}}})",
 			GMDiscord::EscapeJson(player->GetName()),
 			player->GetGUID().GetRawValue(),
 			GMDiscord::EscapeJson(receiverName),
 			discordUserId,
 			ticketId,
 			GMDiscord::EscapeJson(msg),
+			GMDiscord::EscapeJson(GMDiscord::KeywordMatcher::Instance().FormatCategories(GMDiscord::KeywordMatcher::Instance().Scan(msg))),
 			GameTime::GetGameTime().count());
-		GMDiscord::EnqueueOutbox("player_whisper", payload);
+		GMDiscord::EnqueueOutbox("player_whisper", payload, ticketId);
+		GMDiscord::ConversationBuffer::Instance().Append(ticketId, true, player->GetName(), msg, GameTime::GetGameTime().count());
 		ChatHandler(player->GetSession()).PSendSysMessage("Your reply has been sent to Customer Support.");
 
 		return false; // handled, prevent "player not found"
 	}
+
+	void OnPlayerLogin(Player* player) override
+	{
+		uint32 accountId = player->GetSession()->GetAccountId();
+		GMDiscord::GmPresence::Instance().SetInGame(accountId, true);
+		GMDiscord::AutoAssigner::Instance().OnPresenceChanged(accountId);
+	}
+
+	void OnPlayerLogout(Player* player) override
+	{
+		uint32 accountId = player->GetSession()->GetAccountId();
+		GMDiscord::GmPresence::Instance().SetInGame(accountId, false);
+		GMDiscord::AutoAssigner::Instance().OnPresenceChanged(accountId);
+	}
+
+	// No trade hook exists, so a single large money gain (trade, mail,
+	// auction or loot) stands in for suspicious trades.
+	void OnPlayerMoneyChanged(Player* player, int32& amount) override
+	{
+		if (GMDiscord::IsAlertEnabled(GMDiscord::ALERT_GOLD_GAIN) && amount > 0)
+			GMDiscord::AlertPipeline::Instance().Push(GMDiscord::ALERT_GOLD_GAIN, player->GetGUID().GetRawValue(), uint64(amount));
+	}
+
+	void OnPlayerLevelChanged(Player* player, uint8 /*oldLevel*/) override
+	{
+		if (GMDiscord::IsAlertEnabled(GMDiscord::ALERT_LEVEL_SPEEDRUN) && player->GetLevel() >= sWorld->getIntConfig(CONFIG_MAX_PLAYER_LEVEL))
+			GMDiscord::AlertPipeline::Instance().Push(GMDiscord::ALERT_LEVEL_SPEEDRUN, player->GetGUID().GetRawValue(),
+				player->GetTotalPlayedTime(), player->GetLevel());
+	}
+};
+
+class GMDiscordCommandAlertScript : public AllCommandScript
+{
+public:
+	GMDiscordCommandAlertScript() : AllCommandScript("GMDiscordCommandAlertScript") { }
+
+	bool OnTryExecuteCommand(ChatHandler& handler, std::string_view command) override
+	{
+		if (!GMDiscord::IsAlertEnabled(GMDiscord::ALERT_GM_COMMAND))
+			return true;
+
+		// Console and Discord-relayed commands have no session.
+		if (WorldSession* session = handler.GetSession())
+			if (Player* player = session->GetPlayer())
+				GMDiscord::AlertPipeline::Instance().Push(GMDiscord::ALERT_GM_COMMAND, player->GetGUID().GetRawValue(),
+					session->GetSecurity(), 0, command);
+		return true;
+	}
+};
+
+class GMDiscordMailAlertScript : public MailScript
+{
+public:
+	GMDiscordMailAlertScript() : MailScript("GMDiscordMailAlertScript") { }
+
+	void OnBeforeMailDraftSendMailTo(MailDraft* /*mailDraft*/, MailReceiver const& receiver, MailSender const& sender,
+		MailCheckMask& /*checked*/, uint32& /*deliverDelay*/, uint32& /*customExpiration*/, bool& /*deleteMailItemsFromDB*/,
+		bool& /*sendMail*/) override
+	{
+		if (!GMDiscord::IsAlertEnabled(GMDiscord::ALERT_MASS_MAIL) || sender.GetMailMessageType() != MAIL_NORMAL)
+			return;
+
+		GMDiscord::AlertPipeline::Instance().Push(GMDiscord::ALERT_MASS_MAIL,
+			ObjectGuid::Create<HighGuid::Player>(sender.GetSenderId()).GetRawValue(), 0, receiver.GetPlayerGUIDLow());
+	}
 };
 
 void AddSC_gm_discord()
 {
 	GMDiscord::LoadSettings();
+	GMDiscord::RegisterDiscordLogAppender();
 	new GMDiscordTicketScript();
 	new GMDiscordWorldScript();
 	new GMDiscordCommandScript();
 	new GMDiscordPlayerScript();
+	new GMDiscordCommandAlertScript();
+	new GMDiscordMailAlertScript();
 }